@@ -0,0 +1,111 @@
+//
+//  bench.h
+//
+//  Part of Metal64
+//
+//  Helper functions for host benchmarks
+//
+//  Build a benchmark (from directory Host/Benchmarks):
+//
+//    g++ -std=gnu++17 -O2 -ffp-contract=off -pthread -Wno-attributes -I.. -I../../Sources/Metal64/include bench_xxx.cpp -o bench_xxx -lquadmath
+//
+//  The GNU dialect and quadmath are needed by the benchmarks with __float128
+//  references (bench_quad.h), the others also build with -std=c++17 and
+//  without -lquadmath. Add -mfma (or -march=native) for the FMA exact
+//  products.
+//
+//  Created by Dirk Braner on 18.04.26.
+//
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "CPUCompute.h"
+#include "f64.h"
+
+
+// ----------------------------------------------------------------------------
+//  Conversion and error measurement
+// ----------------------------------------------------------------------------
+
+// Convert float2 to long double (reference precision)
+static inline long double ld(float2 a) {
+    return (long double)a.x + (long double)a.y;
+}
+
+// Convert long double to float2
+static inline float2 f2(long double a) {
+    float hi = float(a);
+    return float2(hi, float(a - hi));
+}
+
+// Error of a double-float result in ulp of a 48 bit mantissa
+static inline double ulp_error(float2 r, long double ref) {
+    long double e = fabsl(ld(r) - ref);
+    long double m = fabsl(ref);
+    if (m < 1e-30L) m = 1e-30L;
+    int exp;
+    frexpl(m, &exp);
+    return double(e / ldexpl(1.0L, exp - 48));
+}
+
+// Maximum and mean error
+struct ErrorStats {
+    double max = 0.0;
+    double sum = 0.0;
+    size_t count = 0;
+
+    void add(double e) {
+        if (!(e <= max)) max = e;
+        sum += e;
+        count++;
+    }
+
+    double mean() const {
+        return count > 0 ? sum / double(count) : 0.0;
+    }
+};
+
+
+// ----------------------------------------------------------------------------
+//  Timing
+// ----------------------------------------------------------------------------
+
+// Keeps results alive
+static volatile float bench_sink;
+
+// Nanoseconds per call of fnc(i) for i in [0, n), best of reps runs
+template <typename F>
+static double ns_per_call(size_t n, F fnc, int reps = 5) {
+    double best = 1e30;
+    for (int r = 0; r < reps; r++) {
+        float acc = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++) {
+            acc += fnc(i);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        bench_sink = acc;
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / double(n);
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+// Uniformly distributed random f64 values in [lo, hi)
+static inline std::vector<float2> random_f64(size_t n, double lo, double hi, unsigned seed = 12345) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<float2> v(n);
+    for (auto &x : v) {
+        x = f2(dist(gen));
+    }
+    return v;
+}
+
+#endif
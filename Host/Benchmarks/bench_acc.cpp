@@ -0,0 +1,81 @@
+//
+//  bench_acc.cpp
+//
+//  Part of Metal64
+//
+//  Sums and dot products with the unnormalized accumulator f64acc compared to
+//  a chain of f64 additions
+//
+//  Requires GCC quadmath, see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench_quad.h"
+#include "f64acc.h"
+
+// Error in ulp of a 48 bit mantissa of the result
+static inline double ulp(f64 r, quad ref) {
+    quad e = fabsq(((quad)r.v.x + (quad)r.v.y) - ref);
+    return double(e / fabsq(ref) * 281474976710656.0Q);
+}
+
+template <typename F>
+static void run(const char *name, size_t n, quad ref, F fnc) {
+    f64 r;
+    auto start = std::chrono::steady_clock::now();
+    const int reps = 5;
+    for (int k = 0; k < reps; k++) r = fnc();
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / double(reps * n);
+    printf("%-26s %10.2f %14.2f\n", name, ns, ulp(r, ref));
+}
+
+int main() {
+    const size_t n = 1000000;
+    std::vector<float2> a = random_f64(n, 0.0, 1.0, 1);
+    std::vector<float2> b = random_f64(n, -1.0, 1.0, 2);
+    std::vector<float2> c = random_f64(n, -1.0, 1.0, 3);
+
+    quad sumA = 0, sumB = 0, dot = 0;
+    for (size_t i = 0; i < n; i++) {
+        sumA += (quad)a[i].x + (quad)a[i].y;
+        sumB += (quad)b[i].x + (quad)b[i].y;
+        dot += ((quad)b[i].x + (quad)b[i].y) * ((quad)c[i].x + (quad)c[i].y);
+    }
+
+    printf("n = %zu\n\n", n);
+    printf("%-26s %10s %14s\n", "operation", "ns/term", "error ulp");
+
+    run("sum [0, 1)   f64 +=", n, sumA, [&]() {
+        f64 s = 0.0f;
+        for (size_t i = 0; i < n; i++) s += f64(a[i]);
+        return s;
+    });
+    run("sum [0, 1)   f64acc +=", n, sumA, [&]() {
+        f64acc s;
+        for (size_t i = 0; i < n; i++) s += f64(a[i]);
+        return dbl(s);
+    });
+    run("sum [-1, 1)  f64 +=", n, sumB, [&]() {
+        f64 s = 0.0f;
+        for (size_t i = 0; i < n; i++) s += f64(b[i]);
+        return s;
+    });
+    run("sum [-1, 1)  f64acc +=", n, sumB, [&]() {
+        f64acc s;
+        for (size_t i = 0; i < n; i++) s += f64(b[i]);
+        return dbl(s);
+    });
+    run("dot [-1, 1)  f64 += a * b", n, dot, [&]() {
+        f64 s = 0.0f;
+        for (size_t i = 0; i < n; i++) s += f64(b[i]) * f64(c[i]);
+        return s;
+    });
+    run("dot [-1, 1)  f64acc addmul", n, dot, [&]() {
+        f64acc s;
+        for (size_t i = 0; i < n; i++) s.addmul(f64(b[i]), f64(c[i]));
+        return dbl(s);
+    });
+    return 0;
+}
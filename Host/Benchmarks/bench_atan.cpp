@@ -0,0 +1,48 @@
+//
+//  bench_atan.cpp
+//
+//  Part of Metal64
+//
+//  Speed and accuracy of the inverse trigonometric functions: CORDIC
+//  (atan2_iterate, asin_iterate, acos_iterate) versus the table driven
+//  polynomial engine atan2_poly() and asin/acos derived from it
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+
+static void print(const char *fnc, const char *engine, double ns, const ErrorStats &e) {
+    printf("%-8s %-8s %10.1f %12.1f %12.2f\n", fnc, engine, ns, e.max, e.mean());
+}
+
+int main() {
+    const size_t n = 200000;
+    std::vector<float2> y = random_f64(n, -10.0, 10.0, 1);
+    std::vector<float2> x = random_f64(n, -10.0, 10.0, 2);
+    std::vector<float2> a = random_f64(n, -1.0, 1.0, 3);
+
+    ErrorStats atanIter, atanPoly, asinIter, asinPoly, acosIter, acosPoly;
+    for (size_t i = 0; i < n; i++) {
+        long double t = atan2l(ld(y[i]), ld(x[i]));
+        atanIter.add(ulp_error(atan2_iterate(y[i], x[i]), t));
+        atanPoly.add(ulp_error(atan2_f64(y[i], x[i]), t));
+
+        long double s = asinl(ld(a[i]));
+        asinIter.add(ulp_error(asin_iterate(a[i]), s));
+        asinPoly.add(ulp_error(asin_f64(a[i]), s));
+
+        long double c = acosl(ld(a[i]));
+        acosIter.add(ulp_error(acos_iterate(a[i]), c));
+        acosPoly.add(ulp_error(acos_f64(a[i]), c));
+    }
+
+    printf("%-8s %-8s %10s %12s %12s\n", "function", "engine", "ns/call", "max ulp", "mean ulp");
+    print("atan2", "CORDIC", ns_per_call(n, [&](size_t i) { return atan2_iterate(y[i], x[i]).x; }, 2), atanIter);
+    print("", "poly", ns_per_call(n, [&](size_t i) { return atan2_f64(y[i], x[i]).x; }), atanPoly);
+    print("asin", "CORDIC", ns_per_call(n, [&](size_t i) { return asin_iterate(a[i]).x; }, 2), asinIter);
+    print("", "poly", ns_per_call(n, [&](size_t i) { return asin_f64(a[i]).x; }), asinPoly);
+    print("acos", "CORDIC", ns_per_call(n, [&](size_t i) { return acos_iterate(a[i]).x; }, 2), acosIter);
+    print("", "poly", ns_per_call(n, [&](size_t i) { return acos_f64(a[i]).x; }), acosPoly);
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+//  bench_cexp.cpp
+//
+//  Part of Metal64
+//
+//  Complex exponential before and after the fused sincos: exp(re) * cos(im)
+//  and exp(re) * sin(im) with two argument reductions versus exp_c64() with
+//  one sincos_f64(). Accuracy of sinh/cosh from one exponential.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include <complex>
+
+#include "bench.h"
+#include "c64.h"
+
+// exp_c64 before: separate sine and cosine
+static inline float4 exp_c64_separate(float4 a) {
+    float2 e = exp_f64(a.xy);
+    return float4(mul_f64(e, cos_f64(a.zw)), mul_f64(e, sin_f64(a.zw)));
+}
+
+// g++ merges the two inlined sincos_poly() calls above. With an opaque call
+// the duplicated argument reduction and polynomials are really executed twice,
+// as on compilers which do not merge them.
+__attribute__((noipa)) static float4 sincos_opaque(float2 a) {
+    return sincos_poly(a);
+}
+
+static inline float4 exp_c64_separate_opaque(float4 a) {
+    float2 e = exp_f64(a.xy);
+    return float4(mul_f64(e, sincos_opaque(a.zw).zw), mul_f64(e, sincos_opaque(a.zw).xy));
+}
+
+static inline float4 exp_c64_fused_opaque(float4 a) {
+    float2 e = exp_f64(a.xy);
+    float4 sc = sincos_opaque(a.zw);
+    return float4(mul_f64(e, sc.zw), mul_f64(e, sc.xy));
+}
+
+int main() {
+    const size_t n = 200000;
+    std::vector<float2> re = random_f64(n, -5.0, 5.0, 1);
+    std::vector<float2> im = random_f64(n, -10.0, 10.0, 2);
+
+    ErrorStats sep, fused;
+    for (size_t i = 0; i < n; i++) {
+        float4 a = float4(re[i], im[i]);
+        std::complex<long double> ref = std::exp(std::complex<long double>(ld(re[i]), ld(im[i])));
+        float4 r = exp_c64_separate(a);
+        sep.add(fmax(ulp_error(r.xy, ref.real()), ulp_error(r.zw, ref.imag())));
+        r = exp_c64(a);
+        fused.add(fmax(ulp_error(r.xy, ref.real()), ulp_error(r.zw, ref.imag())));
+    }
+
+    double tSep = ns_per_call(n, [&](size_t i) { return exp_c64_separate(float4(re[i], im[i])).x; });
+    double tFused = ns_per_call(n, [&](size_t i) { return exp_c64(float4(re[i], im[i])).x; });
+    double tSepOpaque = ns_per_call(n, [&](size_t i) { return exp_c64_separate_opaque(float4(re[i], im[i])).x; });
+    double tFusedOpaque = ns_per_call(n, [&](size_t i) { return exp_c64_fused_opaque(float4(re[i], im[i])).x; });
+
+    printf("%-24s %10s %12s %12s\n", "complex exp", "ns/call", "max ulp", "mean ulp");
+    printf("%-24s %10.1f %12.1f %12.2f\n", "exp * (cos, sin)", tSep, sep.max, sep.mean());
+    printf("%-24s %10.1f %12.1f %12.2f\n", "exp * sincos (fused)", tFused, fused.max, fused.mean());
+    printf("%-24s %10.1f\n", "opaque: 2 x sincos", tSepOpaque);
+    printf("%-24s %10.1f\n", "opaque: 1 x sincos", tFusedOpaque);
+
+    // sinh and cosh
+    std::vector<float2> x = random_f64(n, -20.0, 20.0, 3);
+    std::vector<float2> s = random_f64(n, -0.5, 0.5, 4);
+    ErrorStats sh, ch, shSmall;
+    for (size_t i = 0; i < n; i++) {
+        float4 r = sinhcosh_f64(x[i]);
+        sh.add(ulp_error(r.xy, sinhl(ld(x[i]))));
+        ch.add(ulp_error(r.zw, coshl(ld(x[i]))));
+        shSmall.add(ulp_error(sinh_f64(s[i]), sinhl(ld(s[i]))));
+    }
+    double tSh = ns_per_call(n, [&](size_t i) { return sinhcosh_f64(x[i]).x; });
+
+    printf("\n%-24s %10s %12s %12s\n", "sinhcosh", "ns/call", "max ulp", "mean ulp");
+    printf("%-24s %10.1f %12.1f %12.2f\n", "sinh [-20, 20]", tSh, sh.max, sh.mean());
+    printf("%-24s %10s %12.1f %12.2f\n", "cosh [-20, 20]", "", ch.max, ch.mean());
+    printf("%-24s %10s %12.1f %12.2f\n", "sinh [-0.5, 0.5]", "", shSmall.max, shSmall.mean());
+    return 0;
+}
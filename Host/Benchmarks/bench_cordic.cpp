@@ -0,0 +1,76 @@
+//
+//  bench_cordic.cpp
+//
+//  Part of Metal64
+//
+//  Throughput versus achieved precision of the CORDIC templates in f64iter.h
+//  for the precision targets 24, 32, 40 and 48 bits
+//
+//  Precision in bits = -log2(max |error| / max(|f(x)|, 1))
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+
+static const size_t n = 20000;
+
+// Achieved precision in bits
+struct Precision {
+    long double max = 0.0L;
+
+    void add(float2 r, long double ref) {
+        long double e = fabsl(ld(r) - ref) / fmaxl(fabsl(ref), 1.0L);
+        if (!(e <= max)) max = e;
+    }
+
+    double bits() const {
+        return max > 0.0L ? -double(log2l(max)) : 64.0;
+    }
+};
+
+// One row of the table: fnc<BITS> is called for 24, 32, 40 and 48 bits
+template <int BITS, typename F, typename R>
+static void cell(const std::vector<float2> &x, F fnc, R ref) {
+    Precision p;
+    for (size_t i = 0; i < n; i++) {
+        p.add(fnc(x[i]), ref(ld(x[i])));
+    }
+    double ns = ns_per_call(n, [&](size_t i) { return fnc(x[i]).x; }, 2);
+    printf(" %7.0f %5.1f", ns, p.bits());
+}
+
+#define ROW(name, lo, hi, call, ref)                                        \
+    {                                                                       \
+        std::vector<float2> x = random_f64(n, lo, hi);                      \
+        printf("%-8s", name);                                               \
+        cell<24>(x, [](float2 a) { return call<50, 24>(a); }, ref);         \
+        cell<32>(x, [](float2 a) { return call<50, 32>(a); }, ref);         \
+        cell<40>(x, [](float2 a) { return call<50, 40>(a); }, ref);         \
+        cell<48>(x, [](float2 a) { return call<50, 48>(a); }, ref);         \
+        printf("\n");                                                       \
+    }
+
+template <int N, int BITS>
+static float2 sin_iterate(float2 a) {
+    return sincos_iterate<N, BITS>(a).xy;
+}
+
+template <int N, int BITS>
+static float2 atan_iterate(float2 a) {
+    return atan2_iterate<N, BITS>(a, F2_ONE);
+}
+
+int main() {
+    printf("%-8s %13s %13s %13s %13s\n", "", "24 bits", "32 bits", "40 bits", "48 bits");
+    printf("%-8s", "function");
+    for (int i = 0; i < 4; i++) printf(" %7s %5s", "ns", "bits");
+    printf("\n");
+
+    ROW("sin", -3.14, 3.14, sin_iterate, [](long double a) { return sinl(a); });
+    ROW("atan", -10.0, 10.0, atan_iterate, [](long double a) { return atanl(a); });
+    ROW("exp", -5.0, 5.0, exp_iterate, [](long double a) { return expl(a); });
+    ROW("log", 0.01, 100.0, log_iterate, [](long double a) { return logl(a); });
+    ROW("asin", -1.0, 1.0, asin_iterate, [](long double a) { return asinl(a); });
+    return 0;
+}
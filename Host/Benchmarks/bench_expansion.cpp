@@ -0,0 +1,130 @@
+//
+//  bench_expansion.cpp
+//
+//  Part of Metal64
+//
+//  expansion<N> (expansion.h): generic algorithms versus the tuned kernels of
+//  f64fnc.h (N = 2) and f128fnc.h (N = 4), and the 3-float tier f96
+//
+//  The accuracy is the minimum number of correct bits against __float128.
+//  Arguments in [0.5, 2), sqrt also over [0.5, 2) * 2^k, -50 <= k <= 120.
+//
+//  Requires GCC quadmath, see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench_quad.h"
+#include "expansion.h"
+
+template <int N>
+static inline quad qx(expansion<N> a) {
+    quad r = 0;
+    for (int i = N - 1; i >= 0; i--) r += (quad)a.v[i];
+    return r;
+}
+
+template <int N>
+static inline double bits(expansion<N> r, quad ref) {
+    quad e = fabsq(qx(r) - ref);
+    if (e == 0) return 113.0;
+    return -double(log2q(e / fabsq(ref)));
+}
+
+// Random expansions in [lo, hi) with all words populated
+template <int N>
+static std::vector<expansion<N> > random_ex(size_t n, double lo, double hi, unsigned seed) {
+    std::vector<float4> v = random_f128(n, lo, hi, seed);
+    std::vector<expansion<N> > r(n);
+    for (size_t i = 0; i < n; i++) {
+        quad x = q(v[i]);
+        for (int k = 0; k < N; k++) {
+            r[i].v[k] = float(x);
+            x -= (quad)r[i].v[k];
+        }
+    }
+    return r;
+}
+
+// Expansions scaled by random powers of two 2^k, kmin <= k <= kmax
+template <int N>
+static std::vector<expansion<N> > random_wide(const std::vector<expansion<N> > &a, int kmin, int kmax, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(kmin, kmax);
+    std::vector<expansion<N> > r = a;
+    for (auto &x : r) {
+        int k = dist(gen);
+        for (int i = 0; i < N; i++) x.v[i] = ldexpf(x.v[i], k);
+    }
+    return r;
+}
+
+template <int N, typename F, typename R>
+static void run(const char *name, const std::vector<expansion<N> > &a, const std::vector<expansion<N> > &b,
+                F fnc, R ref) {
+    double worst = 113.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        worst = fmin(worst, bits(fnc(a[i], b[i]), ref(qx(a[i]), qx(b[i]))));
+    }
+    double t = ns_per_call(a.size(), [&](size_t i) { return fnc(a[i], b[i]).v[0]; });
+    printf("%-26s %10.1f %10.1f\n", name, t, worst);
+}
+
+template <int N>
+static void run_all(bool tuned) {
+    const size_t n = 100000;
+    std::vector<expansion<N> > a = random_ex<N>(n, 0.5, 2.0, 1);
+    std::vector<expansion<N> > b = random_ex<N>(n, -2.0, 2.0, 2);
+    char name[64];
+
+    auto add = [](quad x, quad y) { return x + y; };
+    auto mul = [](quad x, quad y) { return x * y; };
+    auto div = [](quad x, quad y) { return x / y; };
+    auto sqr = [](quad x, quad) { return sqrtq(x); };
+
+    snprintf(name, sizeof(name), "N = %d add generic", N);
+    run<N>(name, a, b, [](expansion<N> x, expansion<N> y) { return ex_add<N>(x, y); }, add);
+    if (tuned) {
+        snprintf(name, sizeof(name), "N = %d add tuned", N);
+        run<N>(name, a, b, [](expansion<N> x, expansion<N> y) { return ex_add(x, y); }, add);
+    }
+    snprintf(name, sizeof(name), "N = %d mul generic", N);
+    run<N>(name, a, b, [](expansion<N> x, expansion<N> y) { return ex_mul<N>(x, y); }, mul);
+    if (tuned) {
+        snprintf(name, sizeof(name), "N = %d mul tuned", N);
+        run<N>(name, a, b, [](expansion<N> x, expansion<N> y) { return ex_mul(x, y); }, mul);
+    }
+    snprintf(name, sizeof(name), "N = %d div generic", N);
+    run<N>(name, a, b, [](expansion<N> x, expansion<N> y) { return ex_div<N>(x, y); }, div);
+    if (tuned) {
+        snprintf(name, sizeof(name), "N = %d div tuned", N);
+        run<N>(name, a, b, [](expansion<N> x, expansion<N> y) { return ex_div(x, y); }, div);
+    }
+    snprintf(name, sizeof(name), "N = %d sqrt generic", N);
+    run<N>(name, a, b, [](expansion<N> x, expansion<N>) { return ex_sqrt<N>(x); }, sqr);
+    if (tuned) {
+        snprintf(name, sizeof(name), "N = %d sqrt tuned", N);
+        run<N>(name, a, b, [](expansion<N> x, expansion<N>) { return ex_sqrt(x); }, sqr);
+    }
+    std::vector<expansion<N> > w = random_wide<N>(a, -50, 120, 3);
+    snprintf(name, sizeof(name), "N = %d sqrt wide generic", N);
+    run<N>(name, w, b, [](expansion<N> x, expansion<N>) { return ex_sqrt<N>(x); }, sqr);
+    if (tuned) {
+        snprintf(name, sizeof(name), "N = %d sqrt wide tuned", N);
+        run<N>(name, w, b, [](expansion<N> x, expansion<N>) { return ex_sqrt(x); }, sqr);
+    }
+    printf("\n");
+}
+
+int main() {
+    printf("%-26s %10s %10s\n", "operation", "ns/call", "min bits");
+    run_all<2>(true);
+    run_all<3>(false);
+    run_all<4>(true);
+
+    // Operators of f96
+    f96 x = f96(2.0), y = sqrt(x);
+    f96 z = y * y - 2.0f;
+    printf("f96: sqrt(2)^2 - 2 = %.3e\n", double(qx(z)));
+    return 0;
+}
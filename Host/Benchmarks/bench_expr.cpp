@@ -0,0 +1,137 @@
+//
+//  bench_expr.cpp
+//
+//  Part of Metal64
+//
+//  Eager f64 / c64 operators versus fused expressions (f64expr.h) for typical
+//  kernel expressions. The error is absolute, in ulp of the largest term
+//  (2^-48 * max |term|), against long double.
+//
+//  g++ -O2 vectorizes some of the eager loops across calls. Build with
+//  -fno-tree-vectorize to compare the scalar code of one GPU thread.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include <complex>
+
+#include "bench.h"
+#include "f64expr.h"
+
+typedef std::complex<long double> cld;
+
+static inline long double ld(f64 a) {
+    return ld(a.v);
+}
+
+static inline cld cl(c64 a) {
+    return cld(ld(a.v.xy), ld(a.v.zw));
+}
+
+// Absolute error in ulp of scale
+static inline double abs_error(long double r, long double ref, long double scale) {
+    int exp;
+    frexpl(scale, &exp);
+    return double(fabsl(r - ref) / ldexpl(1.0L, exp - 48));
+}
+
+static inline float first(f64 a) {
+    return a.v.x;
+}
+
+static inline float first(c64 a) {
+    return a.v.x + a.v.z;
+}
+
+// eager(i) and fused(i) return f64 or c64, value() converts a result to long double
+template <typename E, typename F, typename V, typename R>
+static void run(const char *name, size_t n, E eager, F fused, V value, R ref) {
+    ErrorStats ee, ef;
+    for (size_t i = 0; i < n; i++) {
+        long double scale;
+        long double r = ref(i, scale);
+        ee.add(abs_error(value(eager(i)), r, scale));
+        ef.add(abs_error(value(fused(i)), r, scale));
+    }
+    double te = ns_per_call(n, [&](size_t i) { return first(eager(i)); });
+    double tf = ns_per_call(n, [&](size_t i) { return first(fused(i)); });
+    printf("%-22s %10.1f %10.1f %10.2f %10.2f %10.2f\n", name, te, tf, te / tf, ee.max, ef.max);
+}
+
+int main() {
+    const size_t n = 200000;
+    std::vector<float2> va = random_f64(n, -2.0, 2.0, 1);
+    std::vector<float2> vb = random_f64(n, -2.0, 2.0, 2);
+    std::vector<float2> vc = random_f64(n, -2.0, 2.0, 3);
+    std::vector<float2> vd = random_f64(n, -2.0, 2.0, 4);
+    std::vector<float2> ve = random_f64(n, -2.0, 2.0, 5);
+    std::vector<f64> a(n), b(n), c(n), d(n), e(n);
+    std::vector<c64> z(n), w(n), u(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = f64(va[i]); b[i] = f64(vb[i]); c[i] = f64(vc[i]); d[i] = f64(vd[i]); e[i] = f64(ve[i]);
+        z[i] = c64(va[i], vb[i]); w[i] = c64(vc[i], vd[i]); u[i] = c64(ve[i], va[i]);
+    }
+
+    auto real = [](f64 r) { return ld(r); };
+    auto re = [](c64 r) { return cl(r).real(); };
+    auto im = [](c64 r) { return cl(r).imag(); };
+
+    printf("%-22s %10s %10s %10s %10s %10s\n", "expression", "eager ns", "fused ns", "speedup",
+           "eager err", "fused err");
+
+    run("a * b + c", n,
+        [&](size_t i) { return a[i] * b[i] + c[i]; },
+        [&](size_t i) { return f64(fused(a[i]) * b[i] + c[i]); }, real,
+        [&](size_t i, long double &s) {
+            long double p = ld(a[i]) * ld(b[i]);
+            s = fmaxl(fabsl(p), fabsl(ld(c[i])));
+            return p + ld(c[i]);
+        });
+
+    run("a * b + c * d", n,
+        [&](size_t i) { return a[i] * b[i] + c[i] * d[i]; },
+        [&](size_t i) { return f64(fused(a[i]) * b[i] + fused(c[i]) * d[i]); }, real,
+        [&](size_t i, long double &s) {
+            long double p = ld(a[i]) * ld(b[i]), q = ld(c[i]) * ld(d[i]);
+            s = fmaxl(fabsl(p), fabsl(q));
+            return p + q;
+        });
+
+    run("a * b + c * d - e", n,
+        [&](size_t i) { return a[i] * b[i] + c[i] * d[i] - e[i]; },
+        [&](size_t i) { return f64(fused(a[i]) * b[i] + fused(c[i]) * d[i] - e[i]); }, real,
+        [&](size_t i, long double &s) {
+            long double p = ld(a[i]) * ld(b[i]), q = ld(c[i]) * ld(d[i]);
+            s = fmaxl(fmaxl(fabsl(p), fabsl(q)), fabsl(ld(e[i])));
+            return p + q - ld(e[i]);
+        });
+
+    run("(a - b) * (c + d)", n,
+        [&](size_t i) { return (a[i] - b[i]) * (c[i] + d[i]); },
+        [&](size_t i) { return f64((fused(a[i]) - b[i]) * (fused(c[i]) + d[i])); }, real,
+        [&](size_t i, long double &s) {
+            long double r = (ld(a[i]) - ld(b[i])) * (ld(c[i]) + ld(d[i]));
+            s = fabsl(r);
+            return r;
+        });
+
+    run("z * w + u (re)", n,
+        [&](size_t i) { return z[i] * w[i] + u[i]; },
+        [&](size_t i) { return c64(fused(z[i]) * w[i] + u[i]); }, re,
+        [&](size_t i, long double &s) {
+            cld p = cl(z[i]) * cl(w[i]);
+            s = fmaxl(fabsl(ld(z[i].v.xy) * ld(w[i].v.xy)), fabsl(ld(z[i].v.zw) * ld(w[i].v.zw)));
+            s = fmaxl(s, fabsl(ld(u[i].v.xy)));
+            return (p + cl(u[i])).real();
+        });
+
+    run("z * w + u * z (im)", n,
+        [&](size_t i) { return z[i] * w[i] + u[i] * z[i]; },
+        [&](size_t i) { return c64(fused(z[i]) * w[i] + fused(u[i]) * z[i]); }, im,
+        [&](size_t i, long double &s) {
+            cld r = cl(z[i]) * cl(w[i]) + cl(u[i]) * cl(z[i]);
+            s = fmaxl(fabsl(r.imag()), 16.0L);
+            return r.imag();
+        });
+    return 0;
+}
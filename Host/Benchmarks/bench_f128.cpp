@@ -0,0 +1,95 @@
+//
+//  bench_f128.cpp
+//
+//  Part of Metal64
+//
+//  Throughput and accuracy of f128 arithmetic compared to __float128
+//
+//  Arguments in [0.5, 2), sqrt and log also over a wide range of exponents
+//
+//  Requires GCC quadmath, see bench_quad.h
+//
+//  Created by Dirk Braner on 19.04.26.
+//
+
+#include "bench_quad.h"
+
+template <typename F, typename G, typename R>
+static void run(const char *op, const std::vector<float4> &a, const std::vector<float4> &b, F fnc, G quadFnc, R ref) {
+    size_t n = a.size();
+    std::vector<quad> qa(n), qb(n);
+    for (size_t i = 0; i < n; i++) {
+        qa[i] = q(a[i]);
+        qb[i] = q(b[i]);
+    }
+
+    double minBits = 113.0, sumBits = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double c = bits(fnc(a[i], b[i]), ref(qa[i], qb[i]));
+        if (c < minBits) minBits = c;
+        sumBits += c;
+    }
+
+    double t = ns_per_call(n, [&](size_t i) { return fnc(a[i], b[i]).w; }, 3);
+    double tq = ns_per_call(n, [&](size_t i) { return float(quadFnc(qa[i], qb[i])); }, 3);
+    printf("%-12s %12.1f %14.1f %10.1f %10.1f\n", op, t, tq, minBits, sumBits / double(n));
+}
+
+// Random quad floats in [0.5, 2) * 2^k, k uniform in [kmin, kmax]
+static std::vector<float4> random_wide(size_t n, int kmin, int kmax, unsigned seed) {
+    std::vector<float4> v = random_f128(n, 0.5, 2.0, seed);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(kmin, kmax);
+    for (auto &x : v) x = f4(ldexpq(q(x), dist(gen)));
+    return v;
+}
+
+// Same arguments scaled by 2^k
+static std::vector<float4> scaled(const std::vector<float4> &v, int k) {
+    std::vector<float4> r(v.size());
+    for (size_t i = 0; i < v.size(); i++) r[i] = f4(ldexpq(q(v[i]), k));
+    return r;
+}
+
+int main() {
+    const size_t n = 20000;
+    std::vector<float4> a = random_f128(n, 0.5, 2.0, 1);
+    std::vector<float4> b = random_f128(n, 0.5, 2.0, 2);
+
+    printf("%-12s %12s %14s %10s %10s\n", "op", "f128 ns/op", "float128 ns/op", "min bits", "mean bits");
+    run("add", a, b, [](float4 x, float4 y) { return qf_add(x, y); },
+        [](quad x, quad y) { return x + y; }, [](quad x, quad y) { return x + y; });
+    run("sub", a, b, [](float4 x, float4 y) { return qf_sub(x, y); },
+        [](quad x, quad y) { return x - y; }, [](quad x, quad y) { return x - y; });
+    run("mul", a, b, [](float4 x, float4 y) { return qf_mul(x, y); },
+        [](quad x, quad y) { return x * y; }, [](quad x, quad y) { return x * y; });
+    run("div", a, b, [](float4 x, float4 y) { return qf_div(x, y); },
+        [](quad x, quad y) { return x / y; }, [](quad x, quad y) { return x / y; });
+    run("sqrt", a, b, [](float4 x, float4) { return qf_sqrt(x); },
+        [](quad x, quad) { return sqrtq(x); }, [](quad x, quad) { return sqrtq(x); });
+    run("exp", a, b, [](float4 x, float4) { return qf_exp(x); },
+        [](quad x, quad) { return expq(x); }, [](quad x, quad) { return expq(x); });
+    run("log", a, b, [](float4 x, float4) { return qf_log(x); },
+        [](quad x, quad) { return logq(x); }, [](quad x, quad) { return logq(x); });
+
+    // 2^53 ~ 1e16, 2^80 ~ 1e24, 2^100 ~ 1e30. Below about 2^-50 the lowest
+    // words of the square roots are subnormal and a float4 has less bits.
+    printf("\n%-12s %12s %14s %10s %10s\n", "op", "f128 ns/op", "float128 ns/op", "min bits", "mean bits");
+    const int exponents[] = { 53, 80, 100, -50 };
+    for (int k : exponents) {
+        std::vector<float4> s = scaled(a, k);
+        char name[32];
+        snprintf(name, sizeof(name), "sqrt 2^%d", k);
+        run(name, s, b, [](float4 x, float4) { return qf_sqrt(x); },
+            [](quad x, quad) { return sqrtq(x); }, [](quad x, quad) { return sqrtq(x); });
+        snprintf(name, sizeof(name), "log 2^%d", k);
+        run(name, s, b, [](float4 x, float4) { return qf_log(x); },
+            [](quad x, quad) { return logq(x); }, [](quad x, quad) { return logq(x); });
+    }
+    std::vector<float4> w = random_wide(n, -50, 120, 3);
+    run("sqrt wide", w, b, [](float4 x, float4) { return qf_sqrt(x); },
+        [](quad x, quad) { return sqrtq(x); }, [](quad x, quad) { return sqrtq(x); });
+    run("log wide", w, b, [](float4 x, float4) { return qf_log(x); },
+        [](quad x, quad) { return logq(x); }, [](quad x, quad) { return logq(x); });
+    return 0;
+}
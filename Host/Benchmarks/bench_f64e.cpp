@@ -0,0 +1,77 @@
+//
+//  bench_f64e.cpp
+//
+//  Part of Metal64
+//
+//  f64e / c64e (f64e.h) versus f64 / c64: time per operation and the error
+//  of f64e over exponents 2^-4000 ... 2^4000 in ulp of a 48 bit mantissa,
+//  against long double
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+#include "f64e.h"
+
+static inline long double ld(f64e a) {
+    return ldexpl(ld(a.m), a.e);
+}
+
+// Relative error in ulp of a 48 bit mantissa
+static inline double rel_error(f64e r, long double ref) {
+    int exp;
+    frexpl(ref, &exp);
+    return double(fabsl(ld(r) - ref) / ldexpl(1.0L, exp - 48));
+}
+
+template <typename F, typename R>
+static void run(const char *name, const std::vector<f64e> &a, const std::vector<f64e> &b, F fnc, R ref) {
+    ErrorStats e;
+    for (size_t i = 0; i < a.size(); i++) {
+        e.add(rel_error(fnc(a[i], b[i]), ref(ld(a[i]), ld(b[i]))));
+    }
+    double t = ns_per_call(a.size(), [&](size_t i) { return fnc(a[i], b[i]).m.x; });
+    printf("%-10s %10.1f %10.2f %10.3f\n", name, t, e.max, e.mean());
+}
+
+int main() {
+    const size_t n = 200000;
+    std::vector<float2> ma = random_f64(n, -2.0, 2.0, 1);
+    std::vector<float2> mb = random_f64(n, 0.5, 2.0, 2);
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> exp_a(-4000, 4000), exp_d(-60, 60);
+    std::vector<f64e> a(n), b(n);
+    std::vector<f64> fa(n), fb(n);
+    for (size_t i = 0; i < n; i++) {
+        int k = exp_a(gen);
+        a[i] = f64e(ma[i], k);
+        b[i] = f64e(mb[i], k + exp_d(gen));
+        fa[i] = f64(ma[i]);
+        fb[i] = f64(mb[i]);
+    }
+
+    printf("%-10s %10s %10s %10s\n", "f64e op", "ns/call", "max ulp", "mean ulp");
+    run("add", a, b, [](f64e x, f64e y) { return x + y; }, [](long double x, long double y) { return x + y; });
+    run("sub", a, b, [](f64e x, f64e y) { return x - y; }, [](long double x, long double y) { return x - y; });
+    run("mul", a, b, [](f64e x, f64e y) { return x * y; }, [](long double x, long double y) { return x * y; });
+    run("div", a, b, [](f64e x, f64e y) { return x / y; }, [](long double x, long double y) { return x / y; });
+    run("sqrt", b, b, [](f64e x, f64e) { return sqrt(x); }, [](long double x, long double) { return sqrtl(x); });
+
+    printf("\n%-10s %10s\n", "f64 op", "ns/call");
+    printf("%-10s %10.1f\n", "add", ns_per_call(n, [&](size_t i) { return (fa[i] + fb[i]).v.x; }));
+    printf("%-10s %10.1f\n", "mul", ns_per_call(n, [&](size_t i) { return (fa[i] * fb[i]).v.x; }));
+    printf("%-10s %10.1f\n", "div", ns_per_call(n, [&](size_t i) { return (fa[i] / fb[i]).v.x; }));
+
+    // Perturbation step d = 2 z d + d^2 + dc, |d| about 2^-3000
+    std::vector<c64> z(n);
+    std::vector<c64e> d(n), dc(n);
+    for (size_t i = 0; i < n; i++) {
+        z[i] = c64(ma[i], mb[i]);
+        d[i] = c64e(float4(ma[i], mb[i]), -3000);
+        dc[i] = c64e(float4(mb[i], ma[i]), -3020);
+    }
+    double te = ns_per_call(n, [&](size_t i) { return (2.0f * z[i] * d[i] + sqr(d[i]) + dc[i]).m.x; });
+    double tc = ns_per_call(n, [&](size_t i) { return (2.0f * z[i] * z[i] + sqr(z[i]) + z[i]).v.x; });
+    printf("\nperturbation step: c64e %.1f ns, same expression in c64 %.1f ns\n", te, tc);
+    return 0;
+}
@@ -0,0 +1,143 @@
+//
+//  bench_gemm.cpp
+//
+//  Part of Metal64
+//
+//  Blocked f64 / c64 matrix multiplication (f64gemm.h, CPUGemm.h) versus a
+//  naive triple loop of f64 / c64 operators. GFLOP/s counts the equivalent
+//  double operations: 2 M N K for f64, 8 M N K for c64.
+//
+//  Error: max error of sampled elements against long double, in ulp of f64
+//  of sum(|a_ik b_kj|) (2^-48 sum(|a_ik b_kj|)), the error relative to |c|
+//  grows with the cancellation of the sum.
+//
+//  The blocked kernel is compute bound on the CPU. Build with -mfma to use
+//  fma for the exact products, as on the GPU.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include <chrono>
+
+#include "bench.h"
+#include "CPUGemm.h"
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Error in ulp of scale
+static double abs_error(long double r, long double ref, long double scale) {
+    int exp;
+    frexpl(scale, &exp);
+    return double(fabsl(r - ref) / ldexpl(1.0L, exp - 48));
+}
+
+// C = A B of f64 operators
+static void naive_f64(const std::vector<float2> &A, const std::vector<float2> &B, std::vector<float2> &C, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            f64 s = f64(0.0f);
+            for (int k = 0; k < n; k++) s = s + f64(A[i * n + k]) * f64(B[k * n + j]);
+            C[i * n + j] = s.v;
+        }
+    }
+}
+
+// C = A B of c64 operators
+static void naive_c64(const std::vector<float4> &A, const std::vector<float4> &B, std::vector<float4> &C, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            c64 s = c64(0.0f);
+            for (int k = 0; k < n; k++) s = s + c64(A[i * n + k]) * c64(B[k * n + j]);
+            C[i * n + j] = s.v;
+        }
+    }
+}
+
+// Max error of the elements (i, j), on every 37th element
+template <typename E>
+static double max_error(int n, const E &elementError) {
+    double e = 0.0;
+    for (int ij = 0; ij < n * n; ij += 37) e = fmax(e, elementError(ij / n, ij % n));
+    return e;
+}
+
+static void f64_size(int n) {
+    std::vector<float2> A = random_f64(size_t(n) * n, -1.0, 1.0, 1);
+    std::vector<float2> B = random_f64(size_t(n) * n, -1.0, 1.0, 2);
+    std::vector<float2> C1(size_t(n) * n), C2(C1.size());
+    double flops = 2.0 * n * n * n;
+
+    auto start = std::chrono::steady_clock::now();
+    naive_f64(A, B, C1, n);
+    double t1 = seconds(start);
+
+    gemm_params p = cpu_gemm_params(n, n, n, float4(1.0f, 0.0f, 0.0f, 0.0f), float4(0.0f));
+    start = std::chrono::steady_clock::now();
+    cpu_gemm<gemm_f64_tile<>>(A.data(), B.data(), C2.data(), p);
+    double t2 = seconds(start);
+
+    auto error = [&](const std::vector<float2> &C) {
+        return max_error(n, [&](int i, int j) {
+            long double s = 0.0L, scale = 0.0L;
+            for (int k = 0; k < n; k++) {
+                long double ab = ld(A[i * n + k]) * ld(B[k * n + j]);
+                s += ab;
+                scale += fabsl(ab);
+            }
+            return abs_error(ld(C[i * n + j]), s, scale);
+        });
+    };
+    printf("f64  %5d %10.3f %10.3f %8.2fx %10.2f %10.2f\n", n, flops / t1 * 1e-9, flops / t2 * 1e-9, t1 / t2,
+           error(C1), error(C2));
+}
+
+static void c64_size(int n) {
+    std::vector<float2> re = random_f64(2 * size_t(n) * n, -1.0, 1.0, 3);
+    std::vector<float2> im = random_f64(2 * size_t(n) * n, -1.0, 1.0, 4);
+    std::vector<float4> A(size_t(n) * n), B(A.size()), C1(A.size()), C2(A.size());
+    for (size_t k = 0; k < A.size(); k++) {
+        A[k] = float4(re[k], im[k]);
+        B[k] = float4(re[k + A.size()], im[k + A.size()]);
+    }
+    double flops = 8.0 * n * n * n;
+
+    auto start = std::chrono::steady_clock::now();
+    naive_c64(A, B, C1, n);
+    double t1 = seconds(start);
+
+    gemm_params p = cpu_gemm_params(n, n, n, float4(1.0f, 0.0f, 0.0f, 0.0f), float4(0.0f));
+    start = std::chrono::steady_clock::now();
+    cpu_gemm<gemm_c64_tile<>>(A.data(), B.data(), C2.data(), p);
+    double t2 = seconds(start);
+
+    // Error of the real part
+    auto error = [&](const std::vector<float4> &C) {
+        return max_error(n, [&](int i, int j) {
+            long double s = 0.0L, scale = 0.0L;
+            for (int k = 0; k < n; k++) {
+                float4 a = A[i * n + k], b = B[k * n + j];
+                long double p = ld(a.xy) * ld(b.xy), q = ld(a.zw) * ld(b.zw);
+                s += p - q;
+                scale += fabsl(p) + fabsl(q);
+            }
+            return abs_error(ld(C[i * n + j].xy), s, scale);
+        });
+    };
+    printf("c64  %5d %10.3f %10.3f %8.2fx %10.2f %10.2f\n", n, flops / t1 * 1e-9, flops / t2 * 1e-9, t1 / t2,
+           error(C1), error(C2));
+}
+
+int main() {
+    printf("%u threads, blocks %dx%dx%d, tiles %dx%d\n\n", CPUThreadPool::shared().size(), GEMM_BM, GEMM_BN, GEMM_BK,
+           GEMM_TM, GEMM_TN);
+    printf("%-4s %5s %10s %10s %9s %10s %10s\n", "type", "n", "naive GF/s", "gemm GF/s", "speedup", "naive ulp",
+           "gemm ulp");
+    f64_size(128);
+    f64_size(256);
+    f64_size(512);
+    c64_size(128);
+    c64_size(256);
+    return 0;
+}
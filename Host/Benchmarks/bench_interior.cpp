@@ -0,0 +1,90 @@
+//
+//  bench_interior.cpp
+//
+//  Part of Metal64
+//
+//  Interior early-out for the c64 Mandelbrot iteration: analytic cardioid and
+//  period 2 bulb tests (in_cardioid, in_bulb2) and Brent's cycle detection
+//  (c64_period) versus the full iteration, on scenes with many interior
+//  pixels.
+//
+//  interior = pixels with maxIter, iter/int = mean iterations of the interior
+//  pixels that are actually executed, mismatch = pixels with another result
+//  than the full iteration.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include <chrono>
+
+#include "bench.h"
+#include "CPUCompute.h"
+#include "c64.h"
+
+static const int w = 256, h = 192;
+static const float tolerance = 1e-12f;
+
+// Escape iteration of z_1 = c, z_(n+1) = z_n^2 + c, maxIter if interior
+// executed: number of executed iterations
+template <bool ANALYTIC, bool PERIOD>
+static int iterate(c64 c, int maxIter, int &executed) {
+    executed = 0;
+    if (ANALYTIC && (in_cardioid(c) || in_bulb2(c))) return maxIter;
+    c64 z = c;
+    c64_period p = c64_period(z);
+    for (int i = 1; i <= maxIter; i++) {
+        c64_mandel m = mandel_norm(z, c);
+        executed = i;
+        if (m.norm > 4.0f) return i;
+        z = m.z;
+        if (PERIOD && p.check(z, f64(tolerance)) > 0) return maxIter;
+    }
+    return maxIter;
+}
+
+template <bool ANALYTIC, bool PERIOD>
+static double render(const char *name, c64 center, float spacing, int maxIter, std::vector<int> &iter,
+                     const std::vector<int> &ref, double base) {
+    std::vector<int> executed(size_t(w) * h);
+    iter.assign(executed.size(), 0);
+    auto start = std::chrono::steady_clock::now();
+    CPUThreadPool::shared().parallelFor(iter.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            c64 c = center + c64(f64(float(int(k % w) - w / 2) * spacing), f64(float(int(k / w) - h / 2) * spacing));
+            iter[k] = iterate<ANALYTIC, PERIOD>(c, maxIter, executed[k]);
+        }
+    });
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long interior = 0, interiorIter = 0, mismatch = 0;
+    for (size_t k = 0; k < iter.size(); k++) {
+        if (iter[k] == maxIter) {
+            interior++;
+            interiorIter += executed[k];
+        }
+        if (!ref.empty() && iter[k] != ref[k]) mismatch++;
+    }
+    if (base == 0.0) base = t;
+    printf("  %-22s %9.1f %8.2fx %9ld %9ld %9ld\n", name, t * 1000.0, base / t, interior,
+           interior > 0 ? interiorIter / interior : 0, mismatch);
+    return t;
+}
+
+static void scene(const char *title, c64 center, float spacing, int maxIter) {
+    printf("%s: spacing %.1e, maxIter %d\n", title, spacing, maxIter);
+    printf("  %-22s %9s %9s %9s %9s %9s\n", "method", "ms", "speedup", "interior", "iter/int", "mismatch");
+    std::vector<int> ref, iter;
+    double base = render<false, false>("full iteration", center, spacing, maxIter, ref, iter, 0.0);
+    render<true, false>("cardioid and bulb", center, spacing, maxIter, iter, ref, base);
+    render<false, true>("periodicity", center, spacing, maxIter, iter, ref, base);
+    render<true, true>("cardioid, bulb, period", center, spacing, maxIter, iter, ref, base);
+    printf("\n");
+}
+
+int main() {
+    printf("%u threads, %dx%d pixels, tolerance %.0e\n\n", CPUThreadPool::shared().size(), w, h, tolerance);
+    scene("whole set", c64(f64(-0.75f), f64(0.0f)), 2.8f / w, 5000);
+    scene("period 3 bulb", c64(f64(-0.1225f), f64(0.745f)), 0.3f / w, 5000);
+    scene("seahorse valley", c64(f64(-0.7435f), f64(0.1314f)), 1e-4f, 5000);
+    return 0;
+}
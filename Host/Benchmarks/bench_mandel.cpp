@@ -0,0 +1,116 @@
+//
+//  bench_mandel.cpp
+//
+//  Part of Metal64
+//
+//  Mandelbrot iteration z = z^2 + c: fused step (mandel, mandel_norm) compared
+//  to the step composed of c64 operators
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+#include "c64.h"
+
+static const int maxIter = 500;
+
+// Escape iteration count, composed of c64 operators
+static int iterate_ops(c64 c) {
+    c64 z = c;
+    for (int i = 0; i < maxIter; i++) {
+        if (norm(z) > 4.0f) return i;
+        z = z * z + c;
+    }
+    return maxIter;
+}
+
+// Escape iteration count, composed of sqr() and +
+static int iterate_sqr(c64 c) {
+    c64 z = c;
+    for (int i = 0; i < maxIter; i++) {
+        if (norm(z) > 4.0f) return i;
+        z = sqr(z) + c;
+    }
+    return maxIter;
+}
+
+// Escape iteration count, fused step with norm
+static int iterate_fused(c64 c) {
+    c64 z = c;
+    for (int i = 0; i < maxIter; i++) {
+        c64_mandel m = mandel_norm(z, c);
+        if (m.norm > 4.0f) return i;
+        z = m.z;
+    }
+    return maxIter;
+}
+
+// Escape iteration count, long double reference
+static int iterate_ref(long double cr, long double ci) {
+    long double x = cr, y = ci;
+    for (int i = 0; i < maxIter; i++) {
+        if (x * x + y * y > 4.0L) return i;
+        long double t = x * x - y * y + cr;
+        y = 2.0L * x * y + ci;
+        x = t;
+    }
+    return maxIter;
+}
+
+template <typename F>
+static void run(const char *name, const std::vector<c64> &c, const std::vector<int> &ref, F fnc) {
+    std::vector<int> n(c.size());
+    auto start = std::chrono::steady_clock::now();
+    long iterations = 0;
+    for (size_t i = 0; i < c.size(); i++) {
+        n[i] = fnc(c[i]);
+        iterations += n[i];
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double s = std::chrono::duration<double>(stop - start).count();
+
+    int mismatch = 0;
+    for (size_t i = 0; i < c.size(); i++) {
+        if (n[i] != ref[i]) mismatch++;
+    }
+    printf("%-12s %12ld %10.2f %14.1f %10d\n", name, iterations, s * 1e9 / double(iterations), double(iterations) / s * 1e-6, mismatch);
+}
+
+int main() {
+    // Seahorse valley, mostly slowly escaping points
+    const int w = 192, h = 192;
+    const double x0 = -0.7530, y0 = 0.0950, size = 0.02;
+
+    std::vector<c64> c(w * h);
+    std::vector<int> ref(w * h);
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            float2 cr = f2(x0 + size * (double(i) / w - 0.5));
+            float2 ci = f2(y0 + size * (double(j) / h - 0.5));
+            c[j * w + i] = c64(cr, ci);
+            ref[j * w + i] = iterate_ref(ld(cr), ld(ci));
+        }
+    }
+
+    // Single step error against long double
+    ErrorStats eOps, eFused;
+    std::vector<float2> v = random_f64(4 * 100000, -2.0, 2.0, 7);
+    for (size_t i = 0; i < v.size(); i += 4) {
+        c64 z = c64(v[i], v[i + 1]), cc = c64(v[i + 2], v[i + 3]);
+        long double x = ld(v[i]), y = ld(v[i + 1]), cr = ld(v[i + 2]), ci = ld(v[i + 3]);
+        long double re = x * x - y * y + cr, im = 2.0L * x * y + ci;
+        // Absolute error relative to |z|^2 + |c|, in ulp of a 48 bit mantissa
+        long double scale = x * x + y * y + fabsl(cr) + fabsl(ci);
+        c64 a = z * z + cc, b = mandel(z, cc);
+        eOps.add(double(std::max(fabsl(ld(a.v.xy) - re), fabsl(ld(a.v.zw) - im)) / scale * 281474976710656.0L));
+        eFused.add(double(std::max(fabsl(ld(b.v.xy) - re), fabsl(ld(b.v.zw) - im)) / scale * 281474976710656.0L));
+    }
+    printf("Single step error, ulp of |z|^2 + |c|: operators max %.2f mean %.3f, fused max %.2f mean %.3f\n\n",
+           eOps.max, eOps.mean(), eFused.max, eFused.mean());
+
+    printf("%-12s %12s %10s %14s %10s\n", "variant", "iterations", "ns/iter", "Miter/s", "mismatch");
+    run("z * z + c", c, ref, iterate_ops);
+    run("sqr(z) + c", c, ref, iterate_sqr);
+    run("mandel_norm", c, ref, iterate_fused);
+    return 0;
+}
@@ -0,0 +1,157 @@
+//
+//  bench_pert.cpp
+//
+//  Part of Metal64
+//
+//  Perturbation (c64pert.h, CPUPerturb.h) versus brute force iteration of
+//  every pixel, pixels per second on all cores
+//
+//  The reference for the escape iterations is a brute force iteration with
+//  expansion<5> (120 bits) on a sample of pixels. mismatch = sampled pixels
+//  with another escape iteration. Brute force c64 is timed on all pixels, it
+//  cannot resolve pixels below about 1e-14. A few pixels close to the set
+//  are chaotic and differ after thousands of iterations with 48 bit deltas.
+//
+//  Requires GCC quadmath (center coordinates), see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench_quad.h"
+#include "CPUPerturb.h"
+#include "expansion.h"
+
+typedef expansion<5> ex;
+
+static const int w = 160, h = 120;
+
+// Convert __float128 to expansion<5>
+static ex ex5(quad a) {
+    ex r;
+    for (int k = 0; k < 5; k++) {
+        r.v[k] = float(a);
+        a -= (quad)r.v[k];
+    }
+    return r;
+}
+
+// Escape iteration of z_1 = c, z_(n+1) = z_n^2 + c, same count as pert_pixel()
+static int iterate_c64(c64 c, int maxIter) {
+    c64 z = c;
+    for (int i = 1; i <= maxIter; i++) {
+        c64_mandel m = mandel_norm(z, c);
+        if (m.norm > PERT_BAILOUT) return i;
+        z = m.z;
+    }
+    return maxIter;
+}
+
+static int iterate_ex(ex cx, ex cy, int maxIter) {
+    ex x = cx, y = cy;
+    for (int i = 1; i <= maxIter; i++) {
+        float fx = flt(x), fy = flt(y);
+        if (fx * fx + fy * fy > PERT_BAILOUT) return i;
+        ex x2 = sqr(x), y2 = sqr(y);
+        y = 2.0f * x * y + cy;
+        x = x2 - y2 + cx;
+    }
+    return maxIter;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int mismatches(const std::vector<int> &ref, const std::vector<int> &iter) {
+    int m = 0;
+    for (size_t k = 0; k < ref.size(); k++) {
+        if (ref[k] >= 0 && ref[k] != iter[k]) m++;
+    }
+    return m;
+}
+
+static void row(const char *name, double pps, double base, int refs, long iter, long skip, long rebases,
+                long glitched, int mismatch, int compared) {
+    printf("%-26s %12.0f %8.1fx %5d %12ld %6ld %9ld %8ld %5d/%d\n", name, pps, pps / base, refs, iter, skip, rebases,
+           glitched, mismatch, compared);
+}
+
+template <typename Op, bool REBASE, int TERMS = 0>
+static void run(const char *name, ex cx, ex cy, f64e pixel, int maxIter, const std::vector<int> &ref, double base) {
+    std::vector<int> iter;
+    auto start = std::chrono::steady_clock::now();
+    CPUPerturbStats s = cpu_perturb<Op, REBASE, TERMS>(cx, cy, pixel, w, h, maxIter, iter);
+    double pps = double(w) * h / seconds(start);
+    int compared = int(std::count_if(ref.begin(), ref.end(), [](int r) { return r >= 0; }));
+    row(name, pps, base, s.references, s.iterations - s.skipped, s.skipped / (long(w) * h), s.rebases, s.glitched,
+        mismatches(ref, iter), compared);
+}
+
+static void scenario(const char *title, const char *x, const char *y, double px, int maxIter, bool c64Valid) {
+    ex cx = ex5(strtoflt128(x, nullptr)), cy = ex5(strtoflt128(y, nullptr));
+    f64e pixel = f64e(px);
+    CPUThreadPool &pool = CPUThreadPool::shared();
+    auto coord = [&](size_t k, ex &re, ex &im) {
+        int i = int(k % w) - w / 2, j = int(k / w) - h / 2;
+        re = cx + ex(dbl(pixel * float(i)));
+        im = cy + ex(dbl(pixel * float(j)));
+    };
+
+    // Reference iterations on every 97th pixel
+    std::vector<int> ref(size_t(w) * h, -1);
+    std::vector<size_t> sample;
+    for (size_t k = 0; k < ref.size(); k += 97) sample.push_back(k);
+    auto start = std::chrono::steady_clock::now();
+    long sampleIter = 0;
+    pool.parallelFor(sample.size(), [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; s++) {
+            ex re, im;
+            coord(sample[s], re, im);
+            ref[sample[s]] = iterate_ex(re, im, maxIter);
+        }
+    });
+    double bruteEx = double(sample.size()) / seconds(start);
+    for (size_t k : sample) sampleIter += ref[k];
+
+    // Brute force c64 on all pixels
+    std::vector<int> iter(ref.size());
+    start = std::chrono::steady_clock::now();
+    pool.parallelFor(ref.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            ex re, im;
+            coord(k, re, im);
+            iter[k] = iterate_c64(c64(dbl(re), dbl(im)), maxIter);
+        }
+    });
+    double bruteC64 = double(ref.size()) / seconds(start);
+    long total = 0;
+    for (int n : iter) total += n;
+
+    printf("%s: pixel %.0e, %dx%d, maxIter %d, mean iterations %ld (sample)\n", title, px, w, h, maxIter,
+           sampleIter / long(sample.size()));
+    printf("%-26s %12s %9s %5s %12s %6s %9s %8s %s\n", "method", "pixels/s", "vs c64", "refs", "iterations", "skip",
+           "rebases", "glitched", "mismatch");
+    row("brute force c64", bruteC64, bruteC64, 0, total, 0, 0, 0, mismatches(ref, iter), int(sample.size()));
+    row("brute force ex<5>", bruteEx, bruteC64, 0, 0, 0, 0, 0, 0, int(sample.size()));
+    if (c64Valid) {
+        run<pert_float_op, true>("float, rebase", cx, cy, pixel, maxIter, ref, bruteC64);
+    }
+    run<pert_c64_op, true>("c64, rebase", cx, cy, pixel, maxIter, ref, bruteC64);
+    run<pert_c64_op, false>("c64, glitch detection", cx, cy, pixel, maxIter, ref, bruteC64);
+    run<pert_c64e_op, true>("c64e, rebase", cx, cy, pixel, maxIter, ref, bruteC64);
+    if (c64Valid) {
+        run<pert_float_op, true, 8>("float, rebase, series 8", cx, cy, pixel, maxIter, ref, bruteC64);
+    }
+    run<pert_c64_op, true, 8>("c64, rebase, series 8", cx, cy, pixel, maxIter, ref, bruteC64);
+    run<pert_c64_op, true, 16>("c64, rebase, series 16", cx, cy, pixel, maxIter, ref, bruteC64);
+    run<pert_c64e_op, true, 16>("c64e, rebase, series 16", cx, cy, pixel, maxIter, ref, bruteC64);
+    printf("\n");
+}
+
+int main() {
+    printf("%u threads\n\n", CPUThreadPool::shared().size());
+    scenario("shallow", "-0.743643887037151", "0.131825904205330", 1e-11, 4000, true);
+    scenario("deep", "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", 1e-29, 20000,
+             false);
+    return 0;
+}
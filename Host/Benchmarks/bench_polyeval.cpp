@@ -0,0 +1,124 @@
+//
+//  bench_polyeval.cpp
+//
+//  Part of Metal64
+//
+//  Horner versus Estrin (f64polyeval.h) for polynomials of N coefficients:
+//
+//    latency     every argument depends on the previous result
+//    throughput  independent arguments
+//
+//  followed by the kernels of f64poly.h with the scheme of METAL64_POLY_ESTRIN.
+//  Build twice (-DMETAL64_POLY_ESTRIN=0 and 1) to compare the kernels.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+
+// Coefficients 1/k! (exp(x) truncated)
+static float2 c64[16];
+static float c32[16];
+
+template <int N>
+static long double ref_poly(long double x) {
+    long double p = 0.0L, f = 1.0L;
+    for (int k = 1; k < N; k++) f *= k;
+    for (int k = N - 1; k >= 0; k--) {
+        p = p * x + 1.0L / f;
+        f /= (k > 0 ? k : 1);
+    }
+    return p;
+}
+
+// Nanoseconds per call of a dependent chain: the next argument depends on the result
+template <typename F>
+static double ns_latency(const std::vector<float2> &x, F fnc, int reps = 5) {
+    double best = 1e30;
+    for (int r = 0; r < reps; r++) {
+        float2 dep = float2(0.0f);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < x.size(); i++) {
+            dep = fnc(float2(x[i].x + dep.x * 0.0f, x[i].y));
+        }
+        auto stop = std::chrono::steady_clock::now();
+        bench_sink = dep.x;
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / double(x.size());
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+template <int N>
+static void run_f64(const std::vector<float2> &x) {
+    const float2 (&c)[N] = *reinterpret_cast<const float2 (*)[N]>(c64);
+    auto h = [&](float2 a) { return horner_f64(a, c); };
+    auto e = [&](float2 a) { return estrin_f64(a, c); };
+
+    ErrorStats eh, ee;
+    for (float2 a : x) {
+        long double ref = ref_poly<N>(ld(a));
+        eh.add(ulp_error(h(a), ref));
+        ee.add(ulp_error(e(a), ref));
+    }
+
+    size_t n = x.size();
+    double lh = ns_latency(x, h), le = ns_latency(x, e);
+    double th = ns_per_call(n, [&](size_t i) { return h(x[i]).x; });
+    double te = ns_per_call(n, [&](size_t i) { return e(x[i]).x; });
+    printf("f64    %3d %12.1f %12.1f %12.1f %12.1f %10.2f %10.2f\n", N, lh, le, th, te, eh.max, ee.max);
+}
+
+template <int N>
+static void run_f32(const std::vector<float2> &x) {
+    const float (&c)[N] = *reinterpret_cast<const float (*)[N]>(c32);
+    auto h = [&](float2 a) { return float2(horner(a.x, c), 0.0f); };
+    auto e = [&](float2 a) { return float2(estrin(a.x, c), 0.0f); };
+
+    size_t n = x.size();
+    double lh = ns_latency(x, h), le = ns_latency(x, e);
+    double th = ns_per_call(n, [&](size_t i) { return h(x[i]).x; });
+    double te = ns_per_call(n, [&](size_t i) { return e(x[i]).x; });
+    printf("float  %3d %12.1f %12.1f %12.1f %12.1f\n", N, lh, le, th, te);
+}
+
+template <typename F, typename R>
+static void run_kernel(const char *name, double lo, double hi, F fnc, R ref) {
+    const size_t n = 200000;
+    std::vector<float2> x = random_f64(n, lo, hi);
+    ErrorStats e;
+    for (float2 a : x) {
+        e.add(ulp_error(fnc(a), ref(ld(a))));
+    }
+    double t = ns_per_call(n, [&](size_t i) { return fnc(x[i]).x; });
+    printf("%-8s %10.1f %10.2f %10.3f\n", name, t, e.max, e.mean());
+}
+
+int main() {
+    long double f = 1.0L;
+    for (int k = 0; k < 16; k++) {
+        if (k > 0) f *= k;
+        c64[k] = f2(1.0L / f);
+        c32[k] = float(1.0L / f);
+    }
+    std::vector<float2> x = random_f64(200000, -0.5, 0.5);
+
+    printf("%-6s %3s %12s %12s %12s %12s %10s %10s\n", "type", "N", "Horner lat", "Estrin lat",
+           "Horner thr", "Estrin thr", "Horner ulp", "Estrin ulp");
+    run_f32<4>(x);
+    run_f32<8>(x);
+    run_f32<16>(x);
+    run_f64<4>(x);
+    run_f64<8>(x);
+    run_f64<12>(x);
+    run_f64<16>(x);
+
+    printf("\nkernels, METAL64_POLY_ESTRIN = %d\n", METAL64_POLY_ESTRIN);
+    printf("%-8s %10s %10s %10s\n", "function", "ns/call", "max ulp", "mean ulp");
+    run_kernel("exp", -20.0, 20.0, [](float2 a) { return exp_f64(a); }, [](long double a) { return expl(a); });
+    run_kernel("log", 0.01, 100.0, [](float2 a) { return log_f64(a); }, [](long double a) { return logl(a); });
+    run_kernel("sin", -3.2, 3.2, [](float2 a) { return sin_f64(a); }, [](long double a) { return sinl(a); });
+    run_kernel("sinh", -0.5, 0.5, [](float2 a) { return sinh_f64(a); }, [](long double a) { return sinhl(a); });
+    run_kernel("atan", -4.0, 4.0, [](float2 a) { return atan_f64(a); }, [](long double a) { return atanl(a); });
+    return 0;
+}
@@ -0,0 +1,101 @@
+//
+//  bench_prod.cpp
+//
+//  Part of Metal64
+//
+//  Throughput and accuracy of the library kernels built on two_prod():
+//  mul/sqr/div/sqrt for f64 and qf_mul for f128. The exact product variant
+//  is selected at compile time by METAL64_USE_FMA (f64fnc.h):
+//
+//    FMA:    p = a * b, e = fma(a, b, -p)
+//    Dekker: Dekker splitting
+//
+//  Build the file once per variant and compare the two outputs:
+//
+//    g++ -std=c++17 -O2 -ffp-contract=off -mfma -DMETAL64_USE_FMA=1 -I.. -I../../Sources/Metal64/include bench_prod.cpp -o bench_prod_fma
+//    g++ -std=c++17 -O2 -ffp-contract=off -mfma -DMETAL64_USE_FMA=0 -I.. -I../../Sources/Metal64/include bench_prod.cpp -o bench_prod_dekker
+//
+//  The checksum column hashes all result words. two_prod is exact in both
+//  variants, so are the kernels which only sum its results (sqrt_f64,
+//  qf_mul): same checksum. mul_f64, sqr_f64, mul_ds and div_f64 fold the
+//  lower order terms into fma() and differ. Without hardware FMA (-mfma or
+//  -march=native) fma() is a library call and the FMA timings are not
+//  representative.
+//
+//  Created by Dirk Braner on 19.04.26.
+//
+
+#include "bench.h"
+#include "f128fnc.h"
+
+#ifdef __FMA__
+static const bool hardware_fma = true;
+#else
+static const bool hardware_fma = false;
+#endif
+
+// Hash of the result words
+static inline uint32_t hash_words(uint32_t h, const float *w, int count) {
+    for (int k = 0; k < count; k++) {
+        h = (h ^ as_type<uint32_t>(w[k])) * 16777619u;
+    }
+    return h;
+}
+
+// One kernel: ns/op, max. error in ulp and checksum of the results
+template <typename F, typename R>
+static void row(const char *op, size_t n, F fnc, R ref) {
+    ErrorStats e;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i += 10) {
+        float2 r = fnc(i);
+        e.add(ulp_error(r, ref(i)));
+        h = hash_words(h, &r.x, 2);
+    }
+    double t = ns_per_call(n, [&](size_t i) { return fnc(i).y; });
+    printf("%-10s %10.2f %10.2f   %08x\n", op, t, e.max, h);
+}
+
+int main() {
+    const size_t n = 1000000;
+    std::vector<float2> a = random_f64(n, 0.5, 2.0, 1);
+    std::vector<float2> b = random_f64(n, 0.5, 2.0, 2);
+
+    printf("Hardware FMA: %s, METAL64_USE_FMA = %d (%s)\n\n", hardware_fma ? "yes" : "no", METAL64_USE_FMA,
+           METAL64_USE_FMA ? "FMA" : "Dekker");
+    printf("%-10s %10s %10s   %8s\n", "operation", "ns/op", "max ulp", "checksum");
+
+    row("two_prod", n,
+        [&](size_t i) { return two_prod(a[i].x, b[i].x); },
+        [&](size_t i) { return (long double)a[i].x * b[i].x; });
+    row("mul_f64", n,
+        [&](size_t i) { return mul_f64(a[i], b[i]); },
+        [&](size_t i) { return ld(a[i]) * ld(b[i]); });
+    row("sqr_f64", n,
+        [&](size_t i) { return sqr_f64(a[i]); },
+        [&](size_t i) { return ld(a[i]) * ld(a[i]); });
+    row("mul_ds", n,
+        [&](size_t i) { return mul_ds(a[i], b[i].x); },
+        [&](size_t i) { return ld(a[i]) * b[i].x; });
+    row("div_f64", n,
+        [&](size_t i) { return div_f64(a[i], b[i]); },
+        [&](size_t i) { return ld(a[i]) / ld(b[i]); });
+    row("sqrt_f64", n,
+        [&](size_t i) { return sqrt_f64(a[i]); },
+        [&](size_t i) { return sqrtl(ld(a[i])); });
+
+    // qf_mul of f64 operands, the error is measured on the two leading words
+    ErrorStats e;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i += 10) {
+        float4 r = qf_mul(float4(a[i], 0.0f, 0.0f), float4(b[i], 0.0f, 0.0f));
+        e.add(ulp_error(float2(r.x, r.y + r.z), ld(a[i]) * ld(b[i])));
+        h = hash_words(h, &r.x, 4);
+    }
+    double t = ns_per_call(n, [&](size_t i) {
+        return qf_mul(float4(a[i], 0.0f, 0.0f), float4(b[i], 0.0f, 0.0f)).y;
+    });
+    printf("%-10s %10.2f %10.2f   %08x\n", "qf_mul", t, e.max, h);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+//
+//  bench_qfmul.cpp
+//
+//  Part of Metal64
+//
+//  Single pass quad float multiplication (qf_mul, qf_mul_sloppy) compared to the
+//  previous implementations, which called qf_add() after every partial product
+//
+//  Requires GCC quadmath, see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench_quad.h"
+
+// Previous implementations, verbatim except for the names. two_prod() is the
+// current one, which gives the same exact products.
+
+// Previous qf_add: renormalized by quick_two_sum only
+static float4 qf_add_prev(float4 a, float4 b) {
+    float2 s;
+    float4 r;
+
+    s = two_sum(a.x, b.x);
+    r.x = s.x;
+    
+    s = two_sum(a.y, b.y + s.y);
+    r.y = s.x;
+    
+    s = two_sum(a.z, b.z + s.y);
+    r.z = s.x;
+    
+    r.w = a.w + b.w + s.y;
+    
+    s = quick_two_sum(r.x, r.y);
+    r.x = s.x;
+    s = quick_two_sum(s.y, r.z);
+    r.y = s.x;
+    s = quick_two_sum(s.y, r.w);
+    r.z = s.x;
+    r.w = s.y;
+
+    return r;
+}
+
+// Previous qf_mul: 3 partial products, one qf_add per product
+static float4 qf_mul_prev(float4 a, float4 b) {
+    float2 p;
+
+    p = two_prod(a.x, b.x);
+    float4 r = float4(p.x, p.y, 0.0, 0.0);
+
+    p = two_prod(a.x, b.y);
+    r = qf_add_prev(r, float4(0, p.x, p.y, 0));
+    
+    p = two_prod(a.y, b.x);
+    r = qf_add_prev(r, float4(0, p.x, p.y, 0));
+
+    return r;
+}
+
+// Previous qf_mulopt: 6 partial products, one qf_add per product
+static float4 qf_mulopt_prev(float4 a, float4 b) {
+    float2 p;
+
+    p = two_prod(a.x, b.x);
+    float4 r = float4(p.x, p.y, 0.0, 0.0);
+
+    p = two_prod(a.x, b.y);
+    r = qf_add_prev(r, float4(0, p.x, p.y, 0));
+    
+    p = two_prod(a.y, b.x);
+    r = qf_add_prev(r, float4(0, p.x, p.y, 0));
+
+    p = two_prod(a.x, b.z);
+    r = qf_add_prev(r, float4(0, 0, p.x, p.y));
+    
+    p = two_prod(a.z, b.x);
+    r = qf_add_prev(r, float4(0, 0, p.x, p.y));
+    
+    p = two_prod(a.y, b.y);
+    r = qf_add_prev(r, float4(0, 0, p.x, p.y));
+
+    return r;
+}
+
+template <typename F>
+static void run(const char *name, int flops, const std::vector<float4> &a, const std::vector<float4> &b, F fnc) {
+    size_t n = a.size();
+    double minBits = 113.0, sumBits = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double c = bits(fnc(a[i], b[i]), q(a[i]) * q(b[i]));
+        if (c < minBits) minBits = c;
+        sumBits += c;
+    }
+
+    double t = ns_per_call(n, [&](size_t i) { return fnc(a[i], b[i]).w; }, 5);
+    printf("%-16s %6d %10.1f %10.1f %10.1f\n", name, flops, t, minBits, sumBits / double(n));
+}
+
+int main() {
+    const size_t n = 100000;
+    std::vector<float4> a = random_f128(n, 0.5, 2.0, 1);
+    std::vector<float4> b = random_f128(n, -2.0, 2.0, 2);
+
+    // Flop counts with fma based two_prod (2 flops), two_sum 6, quick_two_sum 3,
+    // previous qf_add 31
+    printf("%-16s %6s %10s %10s %10s\n", "function", "flops", "ns/op", "min bits", "mean bits");
+    run("qf_mul (prev)", 68, a, b, qf_mul_prev);
+    run("qf_mulopt (prev)", 167, a, b, qf_mulopt_prev);
+    run("qf_mul", 192, a, b, qf_mul);
+    run("qf_mul_sloppy", 130, a, b, qf_mul_sloppy);
+    return 0;
+}
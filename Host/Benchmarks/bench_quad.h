@@ -0,0 +1,56 @@
+//
+//  bench_quad.h
+//
+//  Part of Metal64
+//
+//  __float128 reference helpers for f128 benchmarks
+//
+//  Requires GCC quadmath, build with -std=gnu++17 and link with -lquadmath
+//
+//  Created by Dirk Braner on 19.04.26.
+//
+
+#ifndef __BENCH_QUAD_H
+#define __BENCH_QUAD_H
+
+#include <quadmath.h>
+
+#include "bench.h"
+#include "f128.h"
+
+typedef __float128 quad;
+
+// Convert float4 to __float128
+static inline quad q(float4 a) {
+    return (quad)a.x + (quad)a.y + (quad)a.z + (quad)a.w;
+}
+
+// Convert __float128 to float4
+static inline float4 f4(quad a) {
+    float4 r;
+    r.x = float(a); a -= r.x;
+    r.y = float(a); a -= r.y;
+    r.z = float(a); a -= r.z;
+    r.w = float(a);
+    return r;
+}
+
+// Number of correct bits
+static inline double bits(float4 r, quad ref) {
+    quad e = fabsq(q(r) - ref);
+    if (e == 0) return 113.0;
+    return -double(log2q(e / fabsq(ref)));
+}
+
+// Random quad floats in [lo, hi) with all 4 words populated
+static inline std::vector<float4> random_f128(size_t n, double lo, double hi, unsigned seed = 1) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<float4> v(n);
+    for (auto &x : v) {
+        x = f4((quad)dist(gen) * (1 + (quad)dist(gen) * 1e-17Q));
+    }
+    return v;
+}
+
+#endif
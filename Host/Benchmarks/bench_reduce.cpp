@@ -0,0 +1,102 @@
+//
+//  bench_reduce.cpp
+//
+//  Part of Metal64
+//
+//  Parallel reductions of f64reduce.h (CPUReduce.h on all cores) compared
+//  to a naive loop of f64 / c64 operators
+//
+//  Requires GCC quadmath, see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench_quad.h"
+#include "CPUReduce.h"
+
+// Best time of reps runs in seconds
+template <typename F>
+static double seconds(F fnc, int reps = 3) {
+    double best = 1e30;
+    for (int r = 0; r < reps; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fnc();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+// Error in ulp of a 48 bit mantissa
+static inline double ulp(float2 r, quad ref) {
+    if (ref == 0) return 0.0;
+    quad e = fabsq(((quad)r.x + (quad)r.y) - ref);
+    return double(e / fabsq(ref) * 281474976710656.0Q);
+}
+
+static void row(const char *op, double bytes, double tNaive, double tReduce, double eNaive, double eReduce) {
+    printf("%-10s %10.2f %10.2f %8.1fx %12.2f %12.2f\n", op, bytes / tNaive * 1e-9, bytes / tReduce * 1e-9,
+           tNaive / tReduce, eNaive, eReduce);
+}
+
+int main() {
+    const size_t n = 1 << 23;
+    std::vector<float2> a = random_f64(n, -1.0, 1.0, 1);
+    std::vector<float2> b = random_f64(n, -1.0, 1.0, 2);
+    std::vector<float4> ca(n / 2), cb(n / 2);
+    for (size_t i = 0; i < n / 2; i++) {
+        ca[i] = float4(a[2 * i], a[2 * i + 1]);
+        cb[i] = float4(b[2 * i], b[2 * i + 1]);
+    }
+
+    auto qd = [](float2 x) { return (quad)x.x + (quad)x.y; };
+    quad qSum = 0, qDot = 0, qNorm = 0, qcRe = 0, qcIm = 0;
+    for (size_t i = 0; i < n; i++) {
+        qSum += qd(a[i]);
+        qDot += qd(a[i]) * qd(b[i]);
+        qNorm += qd(a[i]) * qd(a[i]);
+    }
+    for (size_t i = 0; i < n / 2; i++) {
+        qcRe += qd(ca[i].xy) * qd(cb[i].xy) - qd(ca[i].zw) * qd(cb[i].zw);
+        qcIm += qd(ca[i].xy) * qd(cb[i].zw) + qd(ca[i].zw) * qd(cb[i].xy);
+    }
+    qNorm = sqrtq(qNorm);
+
+    printf("n = %zu f64 / %zu c64, %u threads\n\n", n, n / 2, CPUThreadPool::shared().size());
+    printf("%-10s %10s %10s %9s %12s %12s\n", "reduction", "naive GB/s", "tree GB/s", "speedup", "naive ulp", "tree ulp");
+
+    const double bytes = double(n) * sizeof(float2);
+    float2 rn, rr;
+    float4 cn, cr;
+    double tn, tr;
+
+    tn = seconds([&] { f64 s = 0.0f; for (size_t i = 0; i < n; i++) s += f64(a[i]); rn = s.v; });
+    tr = seconds([&] { rr = cpu_reduce<sum_f64_op>(a.data(), n); });
+    row("sum f64", bytes, tn, tr, ulp(rn, qSum), ulp(rr, qSum));
+
+    tn = seconds([&] { f64 s = 0.0f; for (size_t i = 0; i < n; i++) s += f64(a[i]) * f64(b[i]); rn = s.v; });
+    tr = seconds([&] { rr = cpu_reduce<dot_f64_op>(a.data(), b.data(), n); });
+    row("dot f64", 2 * bytes, tn, tr, ulp(rn, qDot), ulp(rr, qDot));
+
+    tn = seconds([&] { f64 s = 0.0f; for (size_t i = 0; i < n; i++) s += sqr(f64(a[i])); rn = sqrt(s).v; });
+    tr = seconds([&] { rr = cpu_reduce<norm_f64_op>(a.data(), n); });
+    row("norm f64", bytes, tn, tr, ulp(rn, qNorm), ulp(rr, qNorm));
+
+    tn = seconds([&] { f64 s = INFINITY; for (size_t i = 0; i < n; i++) s = min(s, f64(a[i])); rn = s.v; });
+    tr = seconds([&] { rr = cpu_reduce<min_f64_op>(a.data(), n); });
+    row("min f64", bytes, tn, tr, all(rn == rr) ? 0.0 : -1.0, 0.0);
+
+    tn = seconds([&] { f64 s = -INFINITY; for (size_t i = 0; i < n; i++) s = max(s, f64(a[i])); rn = s.v; });
+    tr = seconds([&] { rr = cpu_reduce<max_f64_op>(a.data(), n); });
+    row("max f64", bytes, tn, tr, all(rn == rr) ? 0.0 : -1.0, 0.0);
+
+    tn = seconds([&] { c64 s; for (size_t i = 0; i < n / 2; i++) s = s + c64(ca[i]) * c64(cb[i]); cn = s.v; });
+    tr = seconds([&] { cr = cpu_reduce<dot_c64_op>(ca.data(), cb.data(), n / 2); });
+    row("dot c64", 2 * bytes, tn, tr, std::max(ulp(cn.xy, qcRe), ulp(cn.zw, qcIm)), std::max(ulp(cr.xy, qcRe), ulp(cr.zw, qcIm)));
+
+    tn = seconds([&] { f64 s = 0.0f; for (size_t i = 0; i < n / 2; i++) s += norm(c64(ca[i])); rn = sqrt(s).v; });
+    tr = seconds([&] { rr = cpu_reduce<norm_c64_op>(ca.data(), n / 2); });
+    row("norm c64", bytes, tn, tr, ulp(rn, qNorm), ulp(rr, qNorm));
+
+    return 0;
+}
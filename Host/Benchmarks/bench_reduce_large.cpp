@@ -0,0 +1,69 @@
+//
+//  bench_reduce_large.cpp
+//
+//  Part of Metal64
+//
+//  sin / cos of f64 over the float range: Cody-Waite reduction by PI/2 versus
+//  the Payne-Hanek reduction of reduce_pi_2_large() for large arguments
+//
+//  The error is absolute, in ulp of 1 (2^-48), against __float128.
+//  Cody-Waite is only measured where its table index stays in range.
+//
+//  Requires GCC quadmath, see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench_quad.h"
+
+// sincos with Cody-Waite reduction only (the former sincos_poly)
+static float4 sincos_cody_waite(float2 a) {
+    float fk = rint(a.x * F_2_PI_INV);
+    return sincos_quadrant(sincos_reduced(reduce_pi_2(a, fk)), int(fk));
+}
+
+// sincos with Payne-Hanek reduction for all arguments
+static float4 sincos_payne_hanek(float2 a) {
+    reduced_t red = reduce_pi_2_large(a);
+    return sincos_quadrant(sincos_reduced(red.r), red.k);
+}
+
+// Maximum absolute error of sin and cos in ulp of 1
+template <typename F>
+static double max_error(const std::vector<float2> &a, F fnc) {
+    double m = 0.0;
+    for (float2 v : a) {
+        quad x = (quad)v.x + (quad)v.y;
+        float4 r = fnc(v);
+        quad es = fabsq((quad)r.x + (quad)r.y - sinq(x));
+        quad ec = fabsq((quad)r.z + (quad)r.w - cosq(x));
+        m = fmax(m, ldexp(double(fmaxq(es, ec)), 48));
+    }
+    return m;
+}
+
+static void run(int decade) {
+    const size_t n = 100000;
+    double hi = pow(10.0, double(decade));
+    std::vector<float2> a = random_f64(n, -hi, hi, unsigned(decade));
+
+    double ePH = max_error(a, sincos_payne_hanek);
+    double tPH = ns_per_call(n, [&](size_t i) { return sincos_payne_hanek(a[i]).x; });
+    double tPoly = ns_per_call(n, [&](size_t i) { return sincos_poly(a[i]).x; });
+
+    if (decade <= 6) {
+        double eCW = max_error(a, sincos_cody_waite);
+        double tCW = ns_per_call(n, [&](size_t i) { return sincos_cody_waite(a[i]).x; });
+        printf("1e%-5d %14.1f %12.2f %14.1f %12.2f %12.1f\n", decade, tCW, eCW, tPH, ePH, tPoly);
+    } else {
+        printf("1e%-5d %14s %12s %14.1f %12.2f %12.1f\n", decade, "-", "-", tPH, ePH, tPoly);
+    }
+}
+
+int main() {
+    printf("%-7s %14s %12s %14s %12s %12s\n", "|a| <", "CW ns/call", "CW max err", "PH ns/call", "PH max err", "sincos ns");
+    for (int decade = 1; decade <= 38; decade += decade < 8 ? 1 : 5) {
+        run(decade);
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+//
+//  bench_sincos.cpp
+//
+//  Part of Metal64
+//
+//  Speed and accuracy of sin/cos: CORDIC sincos_iterate() versus
+//  table driven polynomial sincos_poly()
+//
+//  Created by Dirk Braner on 18.04.26.
+//
+
+#include "bench.h"
+
+static void run(const char *range, double lo, double hi) {
+    const size_t n = 200000;
+    std::vector<float2> x = random_f64(n, lo, hi);
+
+    ErrorStats sinIter, cosIter, sinPoly, cosPoly;
+    for (size_t i = 0; i < n; i++) {
+        long double s = sinl(ld(x[i]));
+        long double c = cosl(ld(x[i]));
+        float4 r = sincos_iterate(x[i]);
+        sinIter.add(ulp_error(r.xy, s));
+        cosIter.add(ulp_error(r.zw, c));
+        r = sincos_poly(x[i]);
+        sinPoly.add(ulp_error(r.xy, s));
+        cosPoly.add(ulp_error(r.zw, c));
+    }
+
+    double tIter = ns_per_call(n, [&](size_t i) { return sincos_iterate(x[i]).x; }, 2);
+    double tPoly = ns_per_call(n, [&](size_t i) { return sincos_poly(x[i]).x; });
+
+    printf("%-16s %-8s %10.1f %12.1f %12.2f %12.1f %12.2f\n", range, "CORDIC", tIter,
+           sinIter.max, sinIter.mean(), cosIter.max, cosIter.mean());
+    printf("%-16s %-8s %10.1f %12.1f %12.2f %12.1f %12.2f\n", "", "poly", tPoly,
+           sinPoly.max, sinPoly.mean(), cosPoly.max, cosPoly.mean());
+}
+
+int main() {
+    printf("%-16s %-8s %10s %12s %12s %12s %12s\n", "range", "engine", "ns/call",
+           "sin max ulp", "sin mean", "cos max ulp", "cos mean");
+    run("[-pi/4, pi/4]", -0.785, 0.785);
+    run("[-pi, pi]", -3.14159, 3.14159);
+    run("[-100, 100]", -100.0, 100.0);
+    run("[-1e4, 1e4]", -1e4, 1e4);
+    return 0;
+}
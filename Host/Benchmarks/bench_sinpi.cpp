@@ -0,0 +1,65 @@
+//
+//  bench_sinpi.cpp
+//
+//  Part of Metal64
+//
+//  sin(PI * t) and sin(t * PI/180) through the radian path versus sinpi()
+//  and sind() with exact argument reduction
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+
+static const long double PI_L = 3.141592653589793238462643383279502884L;
+
+// sin(PI * t) with the argument rounded to long double, reduced exactly in long double
+static long double sinpi_ref(long double t) {
+    long double k = rintl(2.0L * t);
+    long double r = t - 0.5L * k;
+    long double s = sinl(PI_L * r), c = cosl(PI_L * r);
+    switch (((long long)fmodl(k, 4.0L) + 4) & 3) {
+        case 1:  return c;
+        case 2:  return -s;
+        case 3:  return -c;
+        default: return s;
+    }
+}
+
+static void run(const char *range, double lo, double hi) {
+    const size_t n = 200000;
+    std::vector<float2> t = random_f64(n, lo, hi);
+    std::vector<float2> d(n);
+    for (size_t i = 0; i < n; i++) {
+        d[i] = f2(ld(t[i]) * 180.0L);
+    }
+
+    ErrorStats radPi, pi, radDeg, deg;
+    for (size_t i = 0; i < n; i++) {
+        long double ref = sinpi_ref(ld(t[i]));
+        radPi.add(ulp_error(sin_f64(mul_f64(t[i], F2_PI)), ref));
+        pi.add(ulp_error(sinpi_f64(t[i]), ref));
+
+        long double refd = sinpi_ref(fmodl(ld(d[i]), 360.0L) / 180.0L);
+        radDeg.add(ulp_error(sin_f64(mul_f64(d[i], F2_PI_180)), refd));
+        deg.add(ulp_error(sind_f64(d[i]), refd));
+    }
+
+    double tRadPi = ns_per_call(n, [&](size_t i) { return sin_f64(mul_f64(t[i], F2_PI)).x; });
+    double tPi = ns_per_call(n, [&](size_t i) { return sinpi_f64(t[i]).x; });
+    double tRadDeg = ns_per_call(n, [&](size_t i) { return sin_f64(mul_f64(d[i], F2_PI_180)).x; });
+    double tDeg = ns_per_call(n, [&](size_t i) { return sind_f64(d[i]).x; });
+
+    printf("%-14s %-18s %10.1f %12.1f %12.2f\n", range, "sin(t * PI)", tRadPi, radPi.max, radPi.mean());
+    printf("%-14s %-18s %10.1f %12.1f %12.2f\n", "", "sinpi(t)", tPi, pi.max, pi.mean());
+    printf("%-14s %-18s %10.1f %12.1f %12.2f\n", "", "sin(d * PI/180)", tRadDeg, radDeg.max, radDeg.mean());
+    printf("%-14s %-18s %10.1f %12.1f %12.2f\n", "", "sind(d)", tDeg, deg.max, deg.mean());
+}
+
+int main() {
+    printf("%-14s %-18s %10s %12s %12s\n", "t range", "function", "ns/call", "max ulp", "mean ulp");
+    run("[-1, 1]", -1.0, 1.0);
+    run("[-100, 100]", -100.0, 100.0);
+    run("[-1e5, 1e5]", -1e5, 1e5);
+    return 0;
+}
@@ -0,0 +1,57 @@
+//
+//  bench_tiers.cpp
+//
+//  Part of Metal64
+//
+//  Throughput and error of the accurate and the sloppy f64 kernels for
+//  add/sub/mul/div. The f64 operators use the tier selected by
+//  METAL64_F64_ACCURATE, build with -DMETAL64_F64_ACCURATE=0 for the sloppy tier.
+//
+//  The flop counts assume the fma based exact product. On the GPU, where
+//  latency is hidden by the number of threads, they determine the throughput.
+//  On the CPU the accurate division is latency bound (3 dependent divisions).
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include "bench.h"
+
+template <typename F, typename R>
+static void row(const char *op, const char *tier, int flops, const std::vector<float2> &a, const std::vector<float2> &b, F fnc, R ref) {
+    size_t n = a.size();
+    ErrorStats e;
+    for (size_t i = 0; i < n; i++) e.add(ulp_error(fnc(a[i], b[i]), ref(ld(a[i]), ld(b[i]))));
+    double ns = ns_per_call(n, [&](size_t i) { return fnc(a[i], b[i]).y; });
+    printf("%-14s %-9s %6d %8.2f %10.1f %12.2f %10.3f\n", op, tier, flops, ns, 1000.0 / ns, e.max, e.mean());
+}
+
+int main() {
+    const size_t n = 1000000;
+    std::vector<float2> a = random_f64(n, 0.5, 2.0, 1);
+    std::vector<float2> b = random_f64(n, 0.5, 2.0, 2);
+    std::vector<float2> c = random_f64(n, -2.0, 2.0, 3);
+
+    auto add = [](long double x, long double y) { return x + y; };
+    auto sub = [](long double x, long double y) { return x - y; };
+    auto mul = [](long double x, long double y) { return x * y; };
+    auto div = [](long double x, long double y) { return x / y; };
+
+    printf("f64 operators use the %s tier\n\n", METAL64_F64_ACCURATE ? "accurate" : "sloppy");
+    printf("%-14s %-9s %6s %8s %10s %12s %10s\n", "operation", "tier", "flops", "ns/op", "Mop/s", "max ulp", "mean ulp");
+
+    row("add", "accurate", 20, a, b, [](float2 x, float2 y) { return add_f64_accurate(x, y); }, add);
+    row("add", "sloppy", 11, a, b, [](float2 x, float2 y) { return add_f64_sloppy(x, y); }, add);
+    row("sub", "accurate", 20, a, b, [](float2 x, float2 y) { return add_f64_accurate(x, -y); }, sub);
+    row("sub", "sloppy", 11, a, b, [](float2 x, float2 y) { return add_f64_sloppy(x, -y); }, sub);
+    row("add (mixed)", "accurate", 20, a, c, [](float2 x, float2 y) { return add_f64_accurate(x, y); }, add);
+    row("add (mixed)", "sloppy", 11, a, c, [](float2 x, float2 y) { return add_f64_sloppy(x, y); }, add);
+    row("mul", "both", 7, a, c, [](float2 x, float2 y) { return mul_f64(x, y); }, mul);
+    row("div", "accurate", 59, a, c, [](float2 x, float2 y) { return div_f64_accurate(x, y); }, div);
+    row("div", "sloppy", 22, a, c, [](float2 x, float2 y) { return div_f64_sloppy(x, y); }, div);
+
+    printf("\n");
+    row("f64 a + b", "selected", METAL64_F64_ACCURATE ? 20 : 11, a, c, [](float2 x, float2 y) { return (f64(x) + f64(y)).v; }, add);
+    row("f64 a / b", "selected", METAL64_F64_ACCURATE ? 59 : 22, a, c, [](float2 x, float2 y) { return (f64(x) / f64(y)).v; }, div);
+
+    return 0;
+}
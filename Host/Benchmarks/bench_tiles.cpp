@@ -0,0 +1,77 @@
+//
+//  bench_tiles.cpp
+//
+//  Part of Metal64
+//
+//  Escape time rendering with the precision chosen per tile (c64tile.h,
+//  CPUTiles.h) versus f64 for all pixels, from a shallow view to a zoom
+//  beyond f64.
+//
+//  Histograms: tiles per estimated and per final precision (f32/f64/f128).
+//  mismatch = pixels with another escape iteration than f128 on a sample of
+//  pixels.
+//
+//  Requires GCC quadmath (center coordinates), see bench_quad.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#include <chrono>
+
+#include "bench_quad.h"
+#include "CPUTiles.h"
+
+static const int w = 256, h = 192;
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void view(const char *title, const char *x, const char *y, float spacing, int maxIter) {
+    f128 cx = f128(f4(strtoflt128(x, nullptr))), cy = f128(f4(strtoflt128(y, nullptr)));
+    CPUThreadPool &pool = CPUThreadPool::shared();
+    float4 x0 = (cx - f128(prod(float(w / 2), spacing))).v;
+    float4 y0 = (cy - f128(prod(float(h / 2), spacing))).v;
+
+    // f64 for all pixels
+    std::vector<int> global(size_t(w) * h);
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(global.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            global[k] = tile_pixel(TILE_F64, x0, y0, spacing, int(k % w), int(k / w), maxIter);
+        }
+    });
+    double tGlobal = seconds(start);
+
+    // Precision per tile
+    std::vector<int> iter;
+    start = std::chrono::steady_clock::now();
+    CPUTileStats s = cpu_render_tiles(cx, cy, spacing, w, h, maxIter, iter);
+    double tTiles = seconds(start);
+
+    // f128 on every 97th pixel
+    int sampled = 0, mGlobal = 0, mTiles = 0;
+    for (size_t k = 0; k < global.size(); k += 97) {
+        int r = tile_pixel(TILE_F128, x0, y0, spacing, int(k % w), int(k / w), maxIter);
+        sampled++;
+        mGlobal += global[k] != r;
+        mTiles += iter[k] != r;
+    }
+
+    printf("%-10s %8.0e %6d %5d/%3d/%3d %5d/%3d/%3d %5d %9.1f %9.1f %7.2fx %4d/%3d %4d/%3d\n", title, spacing, maxIter,
+           s.estimated[TILE_F32], s.estimated[TILE_F64], s.estimated[TILE_F128], s.rendered[TILE_F32],
+           s.rendered[TILE_F64], s.rendered[TILE_F128], s.escalated, tGlobal * 1000.0, tTiles * 1000.0,
+           tGlobal / tTiles, mGlobal, sampled, mTiles, sampled);
+}
+
+int main() {
+    printf("%u threads, %dx%d pixels, %dx%d tiles\n\n", CPUThreadPool::shared().size(), w, h, TILE_SIZE, TILE_SIZE);
+    printf("%-10s %8s %6s %13s %13s %5s %9s %9s %8s %8s %8s\n", "view", "spacing", "iter", "estimated", "rendered",
+           "esc.", "f64 ms", "tiles ms", "speedup", "f64 mis", "tile mis");
+    view("overview", "-0.5", "0.0", 0.0117f, 500);
+    view("valley", "-0.7435", "0.1314", 1e-4f, 1000);
+    view("spiral", "-0.7436438870", "0.1318259042", 1e-6f, 2000);
+    view("minibrot", "-1.7497591451303665", "0.0000000000000000", 1e-9f, 2000);
+    view("deep", "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139", 1e-16f, 5000);
+    return 0;
+}
@@ -0,0 +1,390 @@
+//
+//  CPUCompute.h
+//
+//  Part of Metal64
+//
+//  Host implementation of class CPUCompute
+//
+//  CPUCompute mirrors the Swift class MetalCompute: buffers and values are
+//  added in the order of the kernel function parameters, compute() appends
+//  the result buffer and runs the kernel over a 1D or 2D grid on all CPU
+//  cores. The kernel source is the same as for Metal:
+//
+//    kernel void myKernelFnc(device const float2 *arr,
+//                            device const float2& val,
+//                            device float2 *result,
+//                            uint index [[ thread_position_in_grid ]])
+//
+//  Usage:
+//
+//    CPUCompute cc(myKernelFnc, count);
+//    cc.addArray(arr);
+//    cc.addValue(val);
+//    auto result = cc.compute(float2(0.0f));   // std::optional<std::vector<float2>>
+//
+//  Created by Dirk Braner on 17.04.26.
+//
+
+#ifndef __CPUCOMPUTE_H
+#define __CPUCOMPUTE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "metal_host.h"
+
+using namespace metal;
+
+
+///
+/// Fixed size pool of worker threads
+///
+/// parallelFor() splits a range of indices into chunks which are processed
+/// by the workers and the calling thread. The call returns when all chunks
+/// are finished.
+///
+class CPUThreadPool {
+public:
+    explicit CPUThreadPool(unsigned threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        // The calling thread is worker number 0
+        for (unsigned i = 1; i < threadCount; i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~CPUThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto &t : workers) {
+            t.join();
+        }
+    }
+
+    CPUThreadPool(const CPUThreadPool &) = delete;
+    CPUThreadPool &operator = (const CPUThreadPool &) = delete;
+
+    /// Number of threads including the calling thread
+    unsigned size() const {
+        return unsigned(workers.size()) + 1;
+    }
+
+    /// Pool shared by all CPUCompute objects
+    static CPUThreadPool &shared() {
+        static CPUThreadPool pool;
+        return pool;
+    }
+
+    /// Call fnc(begin, end) for chunks of [0, count)
+    /// - Parameters:
+    ///   - count: Number of indices
+    ///   - fnc: Function processing the indices [begin, end)
+    ///   - grain: Chunk size. Default = count / (8 * number of threads)
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)> &fnc, size_t grain = 0) {
+        if (count == 0) return;
+        if (grain == 0) {
+            grain = std::max<size_t>(1, count / (8 * size()));
+        }
+        if (workers.empty() || count <= grain) {
+            fnc(0, count);
+            return;
+        }
+
+        // Only one parallelFor() at a time
+        std::lock_guard<std::mutex> serialize(jobMutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fnc;
+            jobCount = count;
+            jobGrain = grain;
+            next = 0;
+            busy = unsigned(workers.size());
+            generation++;
+        }
+        wakeup.notify_all();
+
+        runChunks(fnc, count, grain);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return busy == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex jobMutex;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    const std::function<void(size_t, size_t)> *job = nullptr;
+    size_t jobCount = 0;
+    size_t jobGrain = 0;
+    std::atomic<size_t> next{0};
+    unsigned busy = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+
+    void runChunks(const std::function<void(size_t, size_t)> &fnc, size_t count, size_t grain) {
+        for (;;) {
+            size_t begin = next.fetch_add(grain);
+            if (begin >= count) break;
+            fnc(begin, std::min(begin + grain, count));
+        }
+    }
+
+    void workerLoop() {
+        unsigned long seen = 0;
+        for (;;) {
+            const std::function<void(size_t, size_t)> *fnc;
+            size_t count, grain;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                fnc = job;
+                count = jobCount;
+                grain = jobGrain;
+            }
+
+            runChunks(*fnc, count, grain);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+            }
+            finished.notify_one();
+        }
+    }
+};
+
+
+///
+/// Class for running Metal compute kernels on the CPU
+///
+/// Usage:
+///
+/// 1. Create a CPUCompute object
+/// 2. Add input parameters (arrays or scalar values)
+/// 3. Call compute() method => returns array with results
+///
+template <typename... Args>
+class CPUCompute {
+public:
+
+    // Error codes
+    enum class ErrorCode {
+        kernelFunctionError,
+        addBufferError,
+        computeElementsError
+    };
+
+    struct Error : public std::runtime_error {
+        ErrorCode code;
+        Error(ErrorCode code, const std::string &message) : std::runtime_error(message), code(code) {}
+    };
+
+    // Buffer types (arrays)
+    enum class BufferType {
+        inputBuffer = 1,
+        resultBuffer = 2
+    };
+
+    typedef void (*KernelFunction)(Args...);
+
+    ///
+    /// Initialize a compute kernel on a 1D grid
+    ///
+    /// Parameters:
+    ///
+    /// kernelFunction - Kernel compute function, last parameter must be uint
+    /// count - Number of elements in input argument buffer(s)
+    ///
+    CPUCompute(KernelFunction kernelFunction, size_t count, CPUThreadPool &pool = CPUThreadPool::shared())
+        : kernelFunction(kernelFunction), count(count), width(uint(count)), height(1), pool(pool) {
+        static_assert(std::is_same<GridType, uint>::value || std::is_same<GridType, uint2>::value,
+                      "Last kernel parameter must be uint or uint2 [[ thread_position_in_grid ]]");
+        if (count == 0) throw Error(ErrorCode::computeElementsError, "Number of elements must be greater than zero");
+    }
+
+    ///
+    /// Initialize a compute kernel on a 2D grid
+    ///
+    /// Parameters:
+    ///
+    /// kernelFunction - Kernel compute function, last parameter must be uint2
+    /// width, height - Grid size, buffers are stored row by row
+    ///
+    CPUCompute(KernelFunction kernelFunction, uint width, uint height, CPUThreadPool &pool = CPUThreadPool::shared())
+        : kernelFunction(kernelFunction), count(size_t(width) * height), width(width), height(height), pool(pool) {
+        static_assert(std::is_same<GridType, uint2>::value,
+                      "Last kernel parameter of a 2D kernel must be uint2 [[ thread_position_in_grid ]]");
+        if (count == 0) throw Error(ErrorCode::computeElementsError, "Number of elements must be greater than zero");
+    }
+
+    /// Add buffer without copying it. Results written by the kernel are visible in the buffer
+    /// - Parameters:
+    ///   - buffer: Pointer to first element
+    ///   - bufferCount: Number of elements, must match count
+    ///   - bufferType: Type of buffer. Default = .inputBuffer
+    template <typename T>
+    void addBuffer(T *buffer, size_t bufferCount, BufferType bufferType = BufferType::inputBuffer) {
+        if (buffer == nullptr) throw Error(ErrorCode::addBufferError, "Cannot get buffer base address");
+        if (bufferCount != count) throw Error(ErrorCode::addBufferError, "Element count mismatch");
+        arguments.push_back({ std::shared_ptr<void>(), buffer, sizeof(T) });
+        if (bufferType == BufferType::resultBuffer) {
+            resultIndex = arguments.size() - 1;
+        }
+    }
+
+    /// Add copy of array
+    /// - Parameters:
+    ///   - value: The array
+    ///   - bufferType: Type of buffer. Default = .inputBuffer
+    template <typename T>
+    void addArray(const std::vector<T> &value, BufferType bufferType = BufferType::inputBuffer) {
+        if (value.size() != count) throw Error(ErrorCode::addBufferError, "Element count mismatch");
+        auto copy = std::make_shared<std::vector<T>>(value);
+        arguments.push_back({ copy, copy->data(), sizeof(T) });
+        if (bufferType == BufferType::resultBuffer) {
+            resultIndex = arguments.size() - 1;
+        }
+    }
+
+    /// Create array with specified number of elements and add it
+    /// - Parameters:
+    ///   - arrayCount: Number of array elements
+    ///   - initValue: Initial value for array elements
+    ///   - bufferType: Type of buffer. Default = .inputBuffer
+    template <typename T>
+    void addArray(size_t arrayCount, const T &initValue, BufferType bufferType = BufferType::inputBuffer) {
+        addArray(std::vector<T>(arrayCount, initValue), bufferType);
+    }
+
+    /// Add a struct (passed by reference or value to the kernel)
+    /// - Parameter value: The structure
+    template <typename T>
+    void addStruct(const T &value) {
+        addValue(value);
+    }
+
+    /// Add a value
+    /// - Parameter value: The value
+    template <typename T>
+    void addValue(const T &value) {
+        auto copy = std::make_shared<T>(value);
+        arguments.push_back({ copy, copy.get(), sizeof(T) });
+    }
+
+    /// Add array of values. Unlike addArray() the element count is not checked
+    /// - Parameter value: Array of values
+    template <typename T>
+    void addValue(const std::vector<T> &value) {
+        auto copy = std::make_shared<std::vector<T>>(value);
+        arguments.push_back({ copy, copy->data(), sizeof(T) });
+    }
+
+    /// Call kernel function for all grid positions
+    /// - Parameter initValue: Initial value for result array
+    /// - Returns: Result array or std::nullopt on error
+    template <typename T>
+    std::optional<std::vector<T>> compute(const T &initValue) {
+        try {
+            addArray(count, initValue, BufferType::resultBuffer);
+            dispatch();
+
+            const T *result = static_cast<const T *>(arguments[resultIndex].data);
+            std::vector<T> converted(result, result + count);
+            reset();
+            return converted;
+        }
+        catch (const Error &) {
+            reset();
+            return std::nullopt;
+        }
+    }
+
+    /// Call kernel function for all grid positions. Results are written to the buffers
+    /// added with addBuffer()
+    void dispatch() {
+        if (arguments.size() != sizeof...(Args) - 1) {
+            throw Error(ErrorCode::kernelFunctionError, "Number of arguments does not match kernel function");
+        }
+        run(std::make_index_sequence<sizeof...(Args) - 1>());
+    }
+
+    /// Remove all arguments
+    void reset() {
+        arguments.clear();
+        resultIndex = 0;
+    }
+
+private:
+    typedef typename std::tuple_element<sizeof...(Args) - 1, std::tuple<Args...>>::type GridType;
+
+    struct Argument {
+        std::shared_ptr<void> storage;  // Owned copy or empty
+        void *data;
+        size_t elementSize;
+    };
+
+    KernelFunction kernelFunction;
+    size_t count;
+    uint width, height;
+    CPUThreadPool &pool;
+    std::vector<Argument> arguments;
+    size_t resultIndex = 0;
+
+    // Convert argument to type of kernel parameter: pointer, reference or value
+    template <typename A>
+    static A bind(const Argument &arg, size_t index) {
+        typedef typename std::remove_cv<typename std::remove_reference<typename std::remove_pointer<A>::type>::type>::type E;
+        if (sizeof(E) != arg.elementSize) {
+            throw Error(ErrorCode::kernelFunctionError, "Size of argument " + std::to_string(index) + " does not match kernel function");
+        }
+        if constexpr (std::is_pointer<A>::value) {
+            return static_cast<A>(arg.data);
+        }
+        else {
+            return *static_cast<E *>(arg.data);
+        }
+    }
+
+    template <size_t... I>
+    void run(std::index_sequence<I...>) {
+        typedef std::tuple<typename std::tuple_element<I, std::tuple<Args...>>::type...> Bound;
+        Bound bound(bind<typename std::tuple_element<I, std::tuple<Args...>>::type>(arguments[I], I)...);
+        KernelFunction fnc = kernelFunction;
+        uint w = width;
+
+        pool.parallelFor(count, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if constexpr (std::is_same<GridType, uint2>::value) {
+                    fnc(std::get<I>(bound)..., uint2(uint(i % w), uint(i / w)));
+                }
+                else {
+                    fnc(std::get<I>(bound)..., uint(i));
+                }
+            }
+        });
+    }
+};
+
+#endif
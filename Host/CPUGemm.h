@@ -0,0 +1,71 @@
+//
+//  CPUGemm.h
+//
+//  Part of Metal64
+//
+//  Host driver for the matrix multiplication of f64gemm.h
+//
+//  Runs the threadgroups of a Metal dispatch on all CPU cores: every
+//  threadgroup computes a BM x BN block of C with the same blocks and tiles
+//  as gemm_threadgroup(). The threads of a threadgroup are executed one after
+//  the other, the loops over the threads replace the barriers.
+//
+//  Usage:
+//
+//    gemm_params p = cpu_gemm_params(M, N, K, float4(1.0f, 0.0f, 0.0f, 0.0f), float4(0.0f));
+//    cpu_gemm<gemm_f64_tile<>>(A.data(), B.data(), C.data(), p);   // float2 elements
+//    cpu_gemm<gemm_c64_tile<>>(X.data(), Y.data(), Z.data(), p);   // float4 elements
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __CPUGEMM_H
+#define __CPUGEMM_H
+
+#include <vector>
+
+#include "CPUCompute.h"
+#include "f64gemm.h"
+
+/// Parameters of dense matrices without padding (lda = K, ldb = ldc = N)
+static inline gemm_params cpu_gemm_params(int M, int N, int K, float4 alpha, float4 beta) {
+    gemm_params p;
+    p.M = M;
+    p.N = N;
+    p.K = K;
+    p.lda = K;
+    p.ldb = N;
+    p.ldc = N;
+    p.alpha = alpha;
+    p.beta = beta;
+    return p;
+}
+
+/// C = alpha A B + beta C on all CPU cores
+/// - Parameters:
+///   - Tile: gemm_f64_tile<...> or gemm_c64_tile<...>
+template <typename Tile>
+static void cpu_gemm(const typename Tile::element *A, const typename Tile::element *B, typename Tile::element *C,
+                     const gemm_params &p, CPUThreadPool &pool = CPUThreadPool::shared()) {
+    typedef typename Tile::element T;
+    int groupsX = (p.N + Tile::bn - 1) / Tile::bn, groupsY = (p.M + Tile::bm - 1) / Tile::bm;
+
+    pool.parallelFor(size_t(groupsX) * groupsY, [&](size_t begin, size_t end) {
+        // Threadgroup memory and the registers of the threads
+        std::vector<T> As(Tile::bm * Tile::bk), Bs(Tile::bk * Tile::bn);
+        std::vector<Tile> t(Tile::THREADS);
+        for (size_t g = begin; g < end; g++) {
+            int row = int(g / groupsX) * Tile::bm, col = int(g % groupsX) * Tile::bn;
+            for (uint tid = 0; tid < uint(Tile::THREADS); tid++) t[tid] = Tile();
+            for (int k0 = 0; k0 < p.K; k0 += Tile::bk) {
+                for (uint tid = 0; tid < uint(Tile::THREADS); tid++) {
+                    gemm_load<Tile>(A, B, p, row, col, k0, As.data(), Bs.data(), tid);
+                }
+                for (uint tid = 0; tid < uint(Tile::THREADS); tid++) t[tid].accumulate(As.data(), Bs.data(), tid);
+            }
+            for (uint tid = 0; tid < uint(Tile::THREADS); tid++) t[tid].store(C, p, row, col, tid);
+        }
+    }, 1);
+}
+
+#endif
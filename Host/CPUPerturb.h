@@ -0,0 +1,125 @@
+//
+//  CPUPerturb.h
+//
+//  Part of Metal64
+//
+//  Host driver for the perturbation iteration of c64pert.h
+//
+//  Renders an image of width x height pixels around the center (cx, cy) on
+//  all CPU cores. The first reference is the center. With glitch detection
+//  (REBASE = false) the glitched pixels are iterated again with the one of
+//  most iterations as new reference, until no pixel is glitched or
+//  maxReferences is reached.
+//  With TERMS > 0 the pixels skip the first iterations of every reference
+//  with a series approximation of TERMS terms.
+//
+//  Usage:
+//
+//    std::vector<int> iter;
+//    CPUPerturbStats s = cpu_perturb<pert_c64_op>(f128(-0.75), f128(0.1), f64e(1e-20), 512, 512, 5000, iter);
+//    CPUPerturbStats t = cpu_perturb<pert_c64_op, true, 16>(f128(-0.75), f128(0.1), f64e(1e-20), 512, 512, 5000, iter);
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __CPUPERTURB_H
+#define __CPUPERTURB_H
+
+#include <algorithm>
+#include <vector>
+
+#include "CPUCompute.h"
+#include "c64pert.h"
+
+struct CPUPerturbStats {
+    int references = 0;     // Number of reference orbits
+    long iterations = 0;    // Sum of the pixel iterations, including glitched passes
+    long rebases = 0;       // Number of rebases
+    long glitched = 0;      // Pixels still glitched after maxReferences
+    long skipped = 0;       // Sum of the iterations skipped by series approximation
+};
+
+/// Render an image with perturbation
+/// - Parameters:
+///   - Op: Delta type (pert_float_op, pert_c64_op, pert_c64e_op)
+///   - REBASE: Rebasing (true) or glitch detection and new references (false)
+///   - TERMS: Number of series terms, 0 = no series approximation
+///   - cx, cy: Center, T = f64, f128 or expansion<N>
+///   - pixel: Pixel size
+///   - iter: Escape iterations of the pixels, row by row
+template <typename Op, bool REBASE = true, int TERMS = 0, typename T>
+static CPUPerturbStats cpu_perturb(T cx, T cy, f64e pixel, int width, int height, int maxIter, std::vector<int> &iter,
+                                   int maxReferences = 32, CPUThreadPool &pool = CPUThreadPool::shared()) {
+    CPUPerturbStats stats;
+    std::vector<float4> orbit(maxIter + 1);
+    std::vector<pert_result> result(size_t(width) * height);
+    iter.assign(result.size(), 0);
+
+    // Pixels to iterate, all pixels with the center as first reference
+    std::vector<uint> pending(result.size());
+    for (size_t k = 0; k < pending.size(); k++) pending[k] = uint(k);
+    uint ref = uint(height / 2) * width + uint(width / 2);
+
+    while (!pending.empty() && stats.references < maxReferences) {
+        // Reference orbit of pixel ref
+        int ri = int(ref % width) - width / 2, rj = int(ref / width) - height / 2;
+        T rx = cx + T(dbl(pixel * float(ri)));
+        T ry = cy + T(dbl(pixel * float(rj)));
+        int len = pert_reference(rx, ry, maxIter, orbit.data());
+        stats.references++;
+
+        // Series for the pending pixels, the radius is a power of 2 pixels
+        const int K = TERMS > 0 ? TERMS : 1;
+        pert_series<K> series;
+        series.skip = 0;
+        float scale = 1.0f;
+        if (TERMS > 0) {
+            long r2 = 1;
+            for (uint p : pending) {
+                long i = int(p % width) - width / 2 - ri, j = int(p / width) - height / 2 - rj;
+                r2 = std::max(r2, i * i + j * j);
+            }
+            while (double(scale) * scale < double(r2)) scale *= 2.0f;
+            series = pert_series_build<K>(orbit.data(), len, pixel * scale, maxIter);
+        }
+
+        pool.parallelFor(pending.size(), [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; k++) {
+                uint p = pending[k];
+                int i = int(p % width) - width / 2 - ri, j = int(p / width) - height / 2 - rj;
+                typename Op::delta dc = Op::from(pixel * float(i), pixel * float(j));
+                if (series.skip > 0) {
+                    c64 u = c64(float4(float(i) / scale, 0.0f, float(j) / scale, 0.0f));
+                    typename Op::delta d = pert_series_delta<Op>(series, u);
+                    result[p] = pert_pixel<Op, REBASE>(orbit.data(), len, dc, maxIter, series.skip, d);
+                } else {
+                    result[p] = pert_pixel<Op, REBASE>(orbit.data(), len, dc, maxIter);
+                }
+            }
+        });
+        stats.skipped += long(series.skip) * long(pending.size());
+
+        // Glitched pixels are iterated again, the new reference is the one
+        // glitched last: its orbit stays valid for the most iterations
+        std::vector<uint> glitched;
+        int deepest = -1;
+        for (uint p : pending) {
+            stats.iterations += result[p].iter;
+            stats.rebases += result[p].rebases;
+            iter[p] = result[p].iter;
+            if (result[p].glitch) {
+                glitched.push_back(p);
+                if (result[p].iter > deepest) {
+                    deepest = result[p].iter;
+                    ref = p;
+                }
+            }
+        }
+        pending.swap(glitched);
+    }
+
+    stats.glitched = long(pending.size());
+    return stats;
+}
+
+#endif
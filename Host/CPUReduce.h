@@ -0,0 +1,91 @@
+//
+//  CPUReduce.h
+//
+//  Part of Metal64
+//
+//  Host driver for the reductions of f64reduce.h
+//
+//  Runs the same two level layout as a Metal dispatch on all CPU cores:
+//  the buffer is split into threadgroups of groupSize threads, each thread
+//  reduces a contiguous block (level 1), and the states of a threadgroup are
+//  combined with reduce_tree_step (level 2). The partial results of the
+//  threadgroups are combined by the same tree.
+//
+//  Buffers may have 2^32 or more elements, only the length of the block of
+//  one thread must stay below 2^32.
+//
+//  Usage:
+//
+//    float2 s = cpu_reduce<sum_f64_op>(a.data(), a.size());
+//    float2 d = cpu_reduce<dot_f64_op>(a.data(), b.data(), a.size());
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __CPUREDUCE_H
+#define __CPUREDUCE_H
+
+#include <vector>
+
+#include "CPUCompute.h"
+#include "f64reduce.h"
+
+/// Tree reduction of states in place, returns the combined state
+/// - Parameters:
+///   - s: States, padded with Op::identity() to a power of 2
+template <typename Op>
+static typename Op::state cpu_reduce_tree(std::vector<typename Op::state> &s) {
+    for (uint stride = uint(s.size()) / 2; stride > 0; stride >>= 1) {
+        // Threads of one tree level are independent, the loop is the barrier
+        for (uint tid = 0; tid < stride; tid++) {
+            reduce_tree_step<Op>(s.data(), tid, stride);
+        }
+    }
+    return s[0];
+}
+
+/// Reduce a buffer on all CPU cores
+/// - Parameters:
+///   - a: Buffer
+///   - b: Second buffer for dot products, otherwise a
+///   - n: Number of elements
+///   - pool: Thread pool
+///   - groupSize: Threads per threadgroup, power of 2
+template <typename Op>
+static typename Op::result cpu_reduce(const typename Op::element *a, const typename Op::element *b, size_t n,
+                                      CPUThreadPool &pool = CPUThreadPool::shared(), uint groupSize = 64) {
+    // Threadgroups: a few per core for load balancing
+    uint groups = 1;
+    while (groups < 4 * pool.size()) groups <<= 1;
+    size_t threads = size_t(groups) * groupSize;
+    size_t block = (n + threads - 1) / threads;
+
+    std::vector<typename Op::state> partial(groups, Op::identity());
+
+    pool.parallelFor(groups, [&](size_t begin, size_t end) {
+        std::vector<typename Op::state> s(groupSize);
+        for (size_t g = begin; g < end; g++) {
+            // Level 1: every thread reduces a contiguous block
+            for (uint tid = 0; tid < groupSize; tid++) {
+                size_t first = std::min(n, (g * groupSize + tid) * block);
+                size_t last = std::min(n, first + block);
+                // reduce_block indexes with uint: offset the buffers, keep
+                // 64 bit offsets for n >= 2^32
+                s[tid] = reduce_block<Op>(a + first, b + first, 0, uint(last - first));
+            }
+            // Level 2: tree in threadgroup memory
+            partial[g] = cpu_reduce_tree<Op>(s);
+        }
+    }, 1);
+
+    return Op::value(cpu_reduce_tree<Op>(partial));
+}
+
+/// Reduce a buffer on all CPU cores (sum, norm, min, max)
+template <typename Op>
+static typename Op::result cpu_reduce(const typename Op::element *a, size_t n,
+                                      CPUThreadPool &pool = CPUThreadPool::shared(), uint groupSize = 64) {
+    return cpu_reduce<Op>(a, a, n, pool, groupSize);
+}
+
+#endif
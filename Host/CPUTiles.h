@@ -0,0 +1,87 @@
+//
+//  CPUTiles.h
+//
+//  Part of Metal64
+//
+//  Host driver for the escape time rendering of c64tile.h
+//
+//  Renders an image of width x height pixels around the center (cx, cy) tile
+//  by tile on all CPU cores. Every tile starts in the estimated precision and
+//  is rendered again in the next precision as long as tile_check() requests a
+//  check and tile_ambiguous() finds a probe pixel with another escape
+//  iteration.
+//
+//  Usage:
+//
+//    std::vector<int> iter;
+//    CPUTileStats s = cpu_render_tiles(f128(-0.75), f128(0.1), 1e-7f, 1024, 768, 2000, iter);
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __CPUTILES_H
+#define __CPUTILES_H
+
+#include <algorithm>
+#include <vector>
+
+#include "CPUCompute.h"
+#include "c64tile.h"
+
+struct CPUTileStats {
+    int estimated[TILE_PRECISIONS] = {};    // Tiles per estimated precision
+    int rendered[TILE_PRECISIONS] = {};     // Tiles per final precision
+    int escalated = 0;                      // Number of renders again in a higher precision
+};
+
+/// Render an image with the precision chosen per tile
+/// - Parameters:
+///   - cx, cy: Center
+///   - spacing: Pixel spacing
+///   - iter: Escape iterations of the pixels, row by row
+///   - minPrecision: Lowest precision, e.g. TILE_F64 for f64 and f128 only
+static CPUTileStats cpu_render_tiles(f128 cx, f128 cy, float spacing, int width, int height, int maxIter,
+                                     std::vector<int> &iter, int tileSize = TILE_SIZE, int minPrecision = TILE_F32,
+                                     CPUThreadPool &pool = CPUThreadPool::shared()) {
+    CPUTileStats stats;
+    iter.assign(size_t(width) * height, 0);
+
+    // Pixel (0, 0)
+    float4 x0 = (cx - f128(prod(float(width / 2), spacing))).v;
+    float4 y0 = (cy - f128(prod(float(height / 2), spacing))).v;
+
+    int tilesX = (width + tileSize - 1) / tileSize, tilesY = (height + tileSize - 1) / tileSize;
+    std::vector<int> estimated(size_t(tilesX) * tilesY), rendered(estimated.size());
+
+    pool.parallelFor(estimated.size(), [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            int i0 = int(t % tilesX) * tileSize, j0 = int(t / tilesX) * tileSize;
+            int i1 = std::min(i0 + tileSize, width), j1 = std::min(j0 + tileSize, height);
+
+            // Largest coordinate of the tile corners
+            float x = max(abs(x0.x + float(i0) * spacing), abs(x0.x + float(i1) * spacing));
+            float y = max(abs(y0.x + float(j0) * spacing), abs(y0.x + float(j1) * spacing));
+            int bits = tile_required_bits(max(x, y), spacing);
+            int p = max(tile_precision(bits), minPrecision);
+            estimated[t] = p;
+
+            for (;;) {
+                for (int j = j0; j < j1; j++) {
+                    for (int i = i0; i < i1; i++) iter[size_t(j) * width + i] = tile_pixel(p, x0, y0, spacing, i, j, maxIter);
+                }
+                if (!tile_check(p, bits) || !tile_ambiguous(p, x0, y0, spacing, i0, j0, i1, j1, maxIter, iter.data(), width)) break;
+                p++;
+            }
+            rendered[t] = p;
+        }
+    }, 1);
+
+    for (size_t t = 0; t < estimated.size(); t++) {
+        stats.estimated[estimated[t]]++;
+        stats.rendered[rendered[t]]++;
+        stats.escalated += rendered[t] - estimated[t];
+    }
+    return stats;
+}
+
+#endif
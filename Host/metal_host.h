@@ -0,0 +1,226 @@
+//
+//  metal_host.h
+//
+//  Part of Metal64
+//
+//  Host C++ replacement for <metal_stdlib>
+//
+//  Provides the subset of the Metal Shading Language standard library which
+//  is used by the Metal64 headers, so that f64.h, c64.h and f128fnc.h can be
+//  compiled with clang or g++ on any platform:
+//
+//    - vector types float2, float4, int2, uint2 and bool2, bool4
+//      with component access (.x, .y, .z, .w) and the swizzles .xy / .zw
+//    - component wise operators and comparisons
+//    - all(), any(), abs(), floor(), rint(), rsqrt(), ldexp(), as_type<>()
+//    - the address space qualifiers constant, device and threadgroup
+//
+//  Mandatory compiler settings (equivalent to Math Mode = "Safe" in Xcode):
+//
+//    -std=c++17 -O2 -ffp-contract=off
+//
+//  Do not use -ffast-math or -ffp-contract=fast. Double-float arithmetic
+//  relies on correctly rounded float operations without contraction.
+//
+//  Created by Dirk Braner on 17.04.26.
+//
+
+#ifndef __METAL_HOST_H
+#define __METAL_HOST_H
+
+#if defined(__FAST_MATH__)
+#error "Metal64 requires IEEE conforming float arithmetic. Do not compile with -ffast-math"
+#endif
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+
+namespace metal {
+
+using std::abs;
+using std::fabs;
+using std::floor;
+using std::ceil;
+using std::trunc;
+using std::rint;
+using std::isfinite;
+using std::isnan;
+using std::isinf;
+using std::signbit;
+using std::sqrt;
+using std::fma;
+using std::ldexp;
+using std::frexp;
+using std::min;
+using std::max;
+
+typedef unsigned int uint;
+
+// ----------------------------------------------------------------------------
+//  Vector types
+// ----------------------------------------------------------------------------
+
+struct bool2 {
+    bool x, y;
+};
+
+struct bool4 {
+    bool x, y, z, w;
+};
+
+struct float2 {
+    float x, y;
+
+    float2() = default;
+    constexpr float2(float a) : x(a), y(a) {}
+    constexpr float2(float a, float b) : x(a), y(b) {}
+
+    float2 &operator += (float2 a) { x += a.x; y += a.y; return *this; }
+    float2 &operator -= (float2 a) { x -= a.x; y -= a.y; return *this; }
+    float2 &operator *= (float2 a) { x *= a.x; y *= a.y; return *this; }
+    float2 &operator /= (float2 a) { x /= a.x; y /= a.y; return *this; }
+};
+
+inline float2 operator + (float2 a, float2 b);
+inline float2 operator - (float2 a, float2 b);
+
+// Writable two component view into a float4 (.xy, .zw)
+template <int I, int J>
+struct swizzle2 {
+    float e[4];
+
+    operator float2() const { return float2(e[I], e[J]); }
+
+    swizzle2 &operator = (float2 a) { e[I] = a.x; e[J] = a.y; return *this; }
+    swizzle2 &operator = (const swizzle2 &a) { return *this = float2(a); }
+    swizzle2 &operator += (float2 a) { return *this = float2(*this) + a; }
+    swizzle2 &operator -= (float2 a) { return *this = float2(*this) - a; }
+};
+
+struct float4 {
+    union {
+        struct { float x, y, z, w; };
+        swizzle2<0, 1> xy;
+        swizzle2<2, 3> zw;
+    };
+
+    constexpr float4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    constexpr float4(float a) : x(a), y(a), z(a), w(a) {}
+    constexpr float4(float a, float b, float c, float d) : x(a), y(b), z(c), w(d) {}
+    constexpr float4(float2 a, float2 b) : x(a.x), y(a.y), z(b.x), w(b.y) {}
+    constexpr float4(float2 a, float c, float d) : x(a.x), y(a.y), z(c), w(d) {}
+    constexpr float4(float a, float b, float2 c) : x(a), y(b), z(c.x), w(c.y) {}
+    constexpr float4(const float4 &a) : x(a.x), y(a.y), z(a.z), w(a.w) {}
+
+    float4 &operator = (const float4 &a) { x = a.x; y = a.y; z = a.z; w = a.w; return *this; }
+    float4 &operator += (float4 a) { x += a.x; y += a.y; z += a.z; w += a.w; return *this; }
+    float4 &operator -= (float4 a) { x -= a.x; y -= a.y; z -= a.z; w -= a.w; return *this; }
+    float4 &operator *= (float4 a) { x *= a.x; y *= a.y; z *= a.z; w *= a.w; return *this; }
+    float4 &operator /= (float4 a) { x /= a.x; y /= a.y; z /= a.z; w /= a.w; return *this; }
+};
+
+struct int2 {
+    int x, y;
+
+    int2() = default;
+    constexpr int2(int a) : x(a), y(a) {}
+    constexpr int2(int a, int b) : x(a), y(b) {}
+};
+
+struct uint2 {
+    uint x, y;
+
+    uint2() = default;
+    constexpr uint2(uint a) : x(a), y(a) {}
+    constexpr uint2(uint a, uint b) : x(a), y(b) {}
+};
+
+// ----------------------------------------------------------------------------
+//  Component wise operators
+// ----------------------------------------------------------------------------
+
+inline float2 operator - (float2 a) { return float2(-a.x, -a.y); }
+inline float2 operator + (float2 a, float2 b) { return float2(a.x + b.x, a.y + b.y); }
+inline float2 operator - (float2 a, float2 b) { return float2(a.x - b.x, a.y - b.y); }
+inline float2 operator * (float2 a, float2 b) { return float2(a.x * b.x, a.y * b.y); }
+inline float2 operator / (float2 a, float2 b) { return float2(a.x / b.x, a.y / b.y); }
+inline float2 operator + (float2 a, float b) { return float2(a.x + b, a.y + b); }
+inline float2 operator - (float2 a, float b) { return float2(a.x - b, a.y - b); }
+inline float2 operator * (float2 a, float b) { return float2(a.x * b, a.y * b); }
+inline float2 operator / (float2 a, float b) { return float2(a.x / b, a.y / b); }
+inline float2 operator + (float a, float2 b) { return float2(a + b.x, a + b.y); }
+inline float2 operator - (float a, float2 b) { return float2(a - b.x, a - b.y); }
+inline float2 operator * (float a, float2 b) { return float2(a * b.x, a * b.y); }
+inline float2 operator / (float a, float2 b) { return float2(a / b.x, a / b.y); }
+
+inline float4 operator - (float4 a) { return float4(-a.x, -a.y, -a.z, -a.w); }
+inline float4 operator + (float4 a, float4 b) { return float4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline float4 operator - (float4 a, float4 b) { return float4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline float4 operator * (float4 a, float4 b) { return float4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+inline float4 operator / (float4 a, float4 b) { return float4(a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w); }
+inline float4 operator * (float4 a, float b) { return float4(a.x * b, a.y * b, a.z * b, a.w * b); }
+inline float4 operator * (float a, float4 b) { return float4(a * b.x, a * b.y, a * b.z, a * b.w); }
+inline float4 operator / (float4 a, float b) { return float4(a.x / b, a.y / b, a.z / b, a.w / b); }
+
+inline bool2 operator == (float2 a, float2 b) { return bool2{a.x == b.x, a.y == b.y}; }
+inline bool2 operator != (float2 a, float2 b) { return bool2{a.x != b.x, a.y != b.y}; }
+inline bool2 operator <  (float2 a, float2 b) { return bool2{a.x <  b.x, a.y <  b.y}; }
+inline bool2 operator >  (float2 a, float2 b) { return bool2{a.x >  b.x, a.y >  b.y}; }
+inline bool2 operator <= (float2 a, float2 b) { return bool2{a.x <= b.x, a.y <= b.y}; }
+inline bool2 operator >= (float2 a, float2 b) { return bool2{a.x >= b.x, a.y >= b.y}; }
+inline bool2 operator == (float2 a, float b) { return a == float2(b); }
+inline bool2 operator != (float2 a, float b) { return a != float2(b); }
+
+inline bool4 operator == (float4 a, float4 b) { return bool4{a.x == b.x, a.y == b.y, a.z == b.z, a.w == b.w}; }
+inline bool4 operator != (float4 a, float4 b) { return bool4{a.x != b.x, a.y != b.y, a.z != b.z, a.w != b.w}; }
+inline bool4 operator == (float4 a, float b) { return a == float4(b); }
+inline bool4 operator != (float4 a, float b) { return a != float4(b); }
+
+// ----------------------------------------------------------------------------
+//  Relational functions
+// ----------------------------------------------------------------------------
+
+inline bool all(bool2 a) { return a.x && a.y; }
+inline bool any(bool2 a) { return a.x || a.y; }
+inline bool all(bool4 a) { return a.x && a.y && a.z && a.w; }
+inline bool any(bool4 a) { return a.x || a.y || a.z || a.w; }
+
+inline float select(float a, float b, bool c) { return c ? b : a; }
+inline float2 select(float2 a, float2 b, bool c) { return c ? b : a; }
+inline float4 select(float4 a, float4 b, bool c) { return c ? b : a; }
+
+// ----------------------------------------------------------------------------
+//  Math functions
+// ----------------------------------------------------------------------------
+
+inline float rsqrt(float a) { return 1.0f / std::sqrt(a); }
+
+inline float2 abs(float2 a) { return float2(std::fabs(a.x), std::fabs(a.y)); }
+inline float4 abs(float4 a) { return float4(std::fabs(a.x), std::fabs(a.y), std::fabs(a.z), std::fabs(a.w)); }
+inline float2 floor(float2 a) { return float2(std::floor(a.x), std::floor(a.y)); }
+inline float2 fma(float2 a, float2 b, float2 c) { return float2(std::fma(a.x, b.x, c.x), std::fma(a.y, b.y, c.y)); }
+
+// Reinterpret the bits of a value as another type of the same size
+template <typename T, typename S>
+inline T as_type(S a) {
+    static_assert(sizeof(T) == sizeof(S), "as_type: size mismatch");
+    T r;
+    std::memcpy(&r, &a, sizeof(T));
+    return r;
+}
+
+} // namespace metal
+
+// ----------------------------------------------------------------------------
+//  Address space and function qualifiers
+// ----------------------------------------------------------------------------
+
+#define constant const
+#define device
+#define threadgroup
+#define kernel
+
+#endif
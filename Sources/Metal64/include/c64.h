@@ -31,7 +31,7 @@ struct c64 {
     
     /// Initialize real part with 64 bit floating point value
     c64(float2 a) {
-        v.xy = a;
+        v = float4(a, F2_ZERO);
     }
     
     /// Initialize real and imag part with 64 bit floating point values
@@ -40,7 +40,7 @@ struct c64 {
     }
     
     c64(f64 a) {
-        v.xy = a.v;
+        v = float4(a.v, F2_ZERO);
     }
     
     c64(f64 a, f64 b) {
@@ -171,6 +171,11 @@ static inline bool operator != (c64 a, c64 b) {
     return any(a.v != b.v);
 }
 
+// Fused complex multiply-add a * b + c
+static inline c64 fma(c64 a, c64 b, c64 c) {
+    return c64(fma_c64(a.v, b.v, c.v));
+}
+
 static inline c64 sqr(c64 a) {
     return c64(sqr_c64(a.v));
 }
@@ -183,6 +188,19 @@ static inline c64 exp(c64 a) {
     return c64(exp_c64(a.v));
 }
 
+// cis(a) = cos(a) + i sin(a) = exp(i a), rotation by angle a
+static inline c64 cis(f64 a) {
+    return c64(cis_c64(a.v));
+}
+
+static inline c64 sin(c64 a) {
+    return c64(sin_c64(a.v));
+}
+
+static inline c64 cos(c64 a) {
+    return c64(cos_c64(a.v));
+}
+
 static inline f64 norm(c64 a) {
     return f64(norm_c64(a.v));
 }
@@ -196,6 +214,80 @@ static inline f64 arg(c64 a) {
     return f64(atan2_f64(a.v.zw, a.v.xy));
 }
 
+// Mandelbrot step: z^2 + c, fused
+static inline c64 mandel(c64 z, c64 c) {
+    return c64(mandel_c64(z.v, c.v));
+}
+
+// Mandelbrot step with escape test: z^2 + c and norm(z) of the input z
+struct c64_mandel {
+    c64 z;
+    f64 norm;
+};
+
+static inline c64_mandel mandel_norm(c64 z, c64 c) {
+    mandel_c64_t r = mandel_norm_c64(z.v, c.v);
+    c64_mandel m;
+    m.z = c64(r.z);
+    m.norm = f64(r.norm);
+    return m;
+}
+
+// c in the main cardioid of the Mandelbrot set:
+// q (q + x - 1/4) <= y^2 / 4, q = (x - 1/4)^2 + y^2
+static inline bool in_cardioid(c64 c) {
+    f64 x = f64(c.v.xy) - 0.25f;
+    f64 y2 = sqr(f64(c.v.zw));
+    f64 q = sqr(x) + y2;
+    return q * (q + x) <= y2 * 0.25f;
+}
+
+// c in the period 2 bulb of the Mandelbrot set: (x + 1)^2 + y^2 <= 1/16
+static inline bool in_bulb2(c64 c) {
+    return sqr(f64(c.v.xy) + 1.0f) + sqr(f64(c.v.zw)) <= f64(0.0625f);
+}
+
+// Brent's cycle detection for z = z^2 + c: z is compared with a saved orbit
+// value, which is replaced after 1, 2, 4, 8, ... steps. An orbit that returns
+// to the saved value within the tolerance is periodic, c is interior.
+//
+//   c64_period p = c64_period(z);
+//   for (...) {
+//       z = mandel(z, c);
+//       if (p.check(z, tol) > 0) break;   // interior, period p.check()
+//   }
+struct c64_period {
+    c64 saved;
+    int power;      // Steps until the saved value is replaced
+    int steps;      // Steps since the saved value
+
+    c64_period(c64 z) {
+        saved = z;
+        power = 1;
+        steps = 0;
+    }
+
+    /// Next orbit value z, returns the period if |z - saved| < tol in both parts, 0 else
+    int check(c64 z, f64 tol) {
+        steps++;
+        // High parts first, the low parts are below half an ulp of the high parts
+        float dx = z.v.x - saved.v.x, dy = z.v.z - saved.v.z;
+        float ex = tol.v.x + abs(z.v.y) + abs(saved.v.y), ey = tol.v.x + abs(z.v.w) + abs(saved.v.w);
+        if (abs(dx) <= ex && abs(dy) <= ey) {
+            float2 ax = sub_f64(z.v.xy, saved.v.xy), ay = sub_f64(z.v.zw, saved.v.zw);
+            ax = ax.x < 0.0f ? -ax : ax;
+            ay = ay.x < 0.0f ? -ay : ay;
+            if (f64(ax) < tol && f64(ay) < tol) return steps;
+        }
+        if (steps == power) {
+            saved = z;
+            power *= 2;
+            steps = 0;
+        }
+        return 0;
+    }
+};
+
 
 
 #endif
@@ -0,0 +1,193 @@
+//
+//  c64tile.h
+//
+//  Part of Metal64
+//
+//  Escape time rendering with the precision chosen per tile
+//
+//  A tile of pixels is iterated in the cheapest arithmetic that resolves its
+//  pixels: float (24 bits), f64 (48 bits) or f128 (96 bits). The required
+//  bits are the ratio of the coordinate magnitude to the pixel spacing plus
+//  TILE_GUARD_BITS for the growth of the rounding errors:
+//
+//    bits = ilogb(max(|x|, |y|)) - ilogb(spacing) + TILE_GUARD_BITS
+//
+//  The estimate ignores the dynamics: pixels close to the boundary of the set
+//  amplify the rounding errors. If the precision has less than TILE_CHECK_BITS
+//  spare bits, tile_ambiguous() iterates a few probe pixels (corners and
+//  center) of the rendered tile again in the next precision. A tile with
+//  another escape iteration at a probe is rendered again in the next
+//  precision.
+//
+//  All precisions iterate the same pixel coordinates: the origin of the tile
+//  (f128) plus an exact multiple of the float pixel spacing.
+//
+//  Metal kernel, one thread per pixel, the precision of each tile in a
+//  buffer (estimated by the host, raised after tile_ambiguous()):
+//
+//    kernel void tile_kernel(constant float4 &x0 [[ buffer(0) ]],     // f128 coordinates of pixel (0, 0)
+//                            constant float4 &y0 [[ buffer(1) ]],
+//                            constant float &spacing [[ buffer(2) ]],
+//                            constant int &maxIter [[ buffer(3) ]],
+//                            device const int *precision [[ buffer(4) ]],
+//                            device int *iter [[ buffer(5) ]],
+//                            uint2 pos [[ thread_position_in_grid ]],
+//                            uint2 size [[ threads_per_grid ]]) {
+//        int tiles = (size.x + TILE_SIZE - 1) / TILE_SIZE;
+//        int p = precision[(pos.y / TILE_SIZE) * tiles + pos.x / TILE_SIZE];
+//        iter[pos.y * size.x + pos.x] = tile_pixel(p, x0, y0, spacing, pos.x, pos.y, maxIter);
+//    }
+//
+//  Host driver: Host/CPUTiles.h
+//
+//  Render time against f64 for all pixels on the host (bench_tiles.cpp,
+//  1 thread, 256x192 pixels, tiles f32/f64/f128 after the checks):
+//
+//    spacing 1e-2    192/  0/  0 tiles    4.3x
+//    spacing 1e-4    133/ 59/  0 tiles    2.2x
+//    spacing 1e-6      0/192/  0 tiles    1.0x
+//    spacing 1e-16     0/  0/192 tiles    0.05x, f64 wrong on 96% of the pixels
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __C64TILE_H
+#define __C64TILE_H
+
+#include "c64.h"
+#include "f128.h"
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Constants
+// ----------------------------------------------------------------------------
+
+// Precisions
+static constant int TILE_F32 = 0;
+static constant int TILE_F64 = 1;
+static constant int TILE_F128 = 2;
+static constant int TILE_PRECISIONS = 3;
+
+// Default tile size in pixels
+static constant int TILE_SIZE = 16;
+
+// Bits above the pixel spacing
+static constant int TILE_GUARD_BITS = 6;
+
+// Tiles with less spare bits are checked by tile_ambiguous()
+static constant int TILE_CHECK_BITS = 8;
+
+// Escape radius^2
+static constant float TILE_BAILOUT = 4.0f;
+
+
+// ----------------------------------------------------------------------------
+//  Precision estimate
+// ----------------------------------------------------------------------------
+
+// Binary exponent of a normal float
+static inline int tile_ilogb(float a) {
+    return int((as_type<uint>(a) >> 23) & 0xff) - 127;
+}
+
+// Mantissa bits of a precision
+static inline int tile_bits(int precision) {
+    return precision == TILE_F32 ? 24 : precision == TILE_F64 ? 48 : 96;
+}
+
+/// Required bits for pixels of the given spacing
+/// - Parameters:
+///   - magnitude: Largest max(|x|, |y|) of the tile
+///   - spacing: Pixel spacing
+static inline int tile_required_bits(float magnitude, float spacing) {
+    return tile_ilogb(max(magnitude, spacing)) - tile_ilogb(spacing) + TILE_GUARD_BITS;
+}
+
+/// Cheapest precision for the required bits
+static inline int tile_precision(int bits) {
+    return bits <= tile_bits(TILE_F32) ? TILE_F32 : bits <= tile_bits(TILE_F64) ? TILE_F64 : TILE_F128;
+}
+
+/// Check a tile of the precision with tile_ambiguous()
+static inline bool tile_check(int precision, int bits) {
+    return precision < TILE_F128 && tile_bits(precision) - bits < TILE_CHECK_BITS;
+}
+
+
+// ----------------------------------------------------------------------------
+//  Escape iteration z_1 = c, z_(n+1) = z_n^2 + c
+//
+//  Returns the first n with |z_n|^2 > TILE_BAILOUT, maxIter if not escaped
+// ----------------------------------------------------------------------------
+
+static inline int tile_iterate_f32(float2 c, int maxIter) {
+    float2 z = c;
+    for (int i = 1; i <= maxIter; i++) {
+        float xx = z.x * z.x, yy = z.y * z.y;
+        if (xx + yy > TILE_BAILOUT) return i;
+        z = float2(xx - yy + c.x, 2.0f * z.x * z.y + c.y);
+    }
+    return maxIter;
+}
+
+static inline int tile_iterate_f64(float4 c, int maxIter) {
+    float4 z = c;
+    for (int i = 1; i <= maxIter; i++) {
+        mandel_c64_t m = mandel_norm_c64(z, c);
+        if (m.norm.x > TILE_BAILOUT) return i;
+        z = m.z;
+    }
+    return maxIter;
+}
+
+static inline int tile_iterate_f128(float4 cx, float4 cy, int maxIter) {
+    float4 x = cx, y = cy;
+    for (int i = 1; i <= maxIter; i++) {
+        float4 xx = qf_sqr(x), yy = qf_sqr(y);
+        if (xx.x + yy.x > TILE_BAILOUT) return i;
+        y = qf_add(qf_mul(x, y) * 2.0f, cy);
+        x = qf_add(qf_sub(xx, yy), cx);
+    }
+    return maxIter;
+}
+
+
+// ----------------------------------------------------------------------------
+//  Pixels
+// ----------------------------------------------------------------------------
+
+/// Escape iteration of the pixel (i, j) in the given precision
+/// - Parameters:
+///   - x0, y0: f128 coordinates of the pixel (0, 0)
+///   - spacing: Pixel spacing
+static inline int tile_pixel(int precision, float4 x0, float4 y0, float spacing, int i, int j, int maxIter) {
+    // Exact offsets i * spacing, j * spacing
+    float2 dx = prod(float(i), spacing), dy = prod(float(j), spacing);
+    if (precision == TILE_F32) {
+        return tile_iterate_f32(float2(x0.x + dx.x, y0.x + dy.x), maxIter);
+    } else if (precision == TILE_F64) {
+        return tile_iterate_f64(float4(add_f64(x0.xy, dx), add_f64(y0.xy, dy)), maxIter);
+    }
+    return tile_iterate_f128(qf_add(x0, float4(dx, 0.0f, 0.0f)), qf_add(y0, float4(dy, 0.0f, 0.0f)), maxIter);
+}
+
+/// Check the rendered tile (i0, j0) ... (i1 - 1, j1 - 1) at its corners and
+/// center in the next precision
+/// - Parameters:
+///   - iter: Escape iterations of the image, row by row
+///   - width: Width of the image
+/// - Returns: true if a probe has another escape iteration
+static inline bool tile_ambiguous(int precision, float4 x0, float4 y0, float spacing, int i0, int j0, int i1, int j1,
+                                  int maxIter, device const int *iter, int width) {
+    if (precision >= TILE_F128) return false;
+    int pi[5] = { i0, i1 - 1, i0, i1 - 1, (i0 + i1) / 2 };
+    int pj[5] = { j0, j0, j1 - 1, j1 - 1, (j0 + j1) / 2 };
+    for (int k = 0; k < 5; k++) {
+        if (tile_pixel(precision + 1, x0, y0, spacing, pi[k], pj[k], maxIter) != iter[pj[k] * width + pi[k]]) return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,511 @@
+//
+//  expansion.h
+//
+//  Part of Metal64
+//
+//  N-term float expansions
+//
+//    An expansion<N> holds a value as the unevaluated sum of N floats,
+//    ordered by magnitude and non-overlapping after renormalization:
+//      v[0] = Highest value part
+//      v[N-1] = Lowest value part
+//
+//    N = 2   about 48 bits, same format as f64 (float2)
+//    N = 3   about 72 bits, f96
+//    N = 4   about 96 bits, same format as f128 (float4)
+//
+//  The generic algorithms are built on the error-free transformations of
+//  f64fnc.h. Their loops have compile time bounds and are unrolled:
+//
+//    add   words of the same order are added with two_sum, the errors are
+//          carried to the next order
+//    mul   the products a[i] * b[j] are collected by order i + j with two_prod
+//          and two_sum, products of order N are plain floats
+//    div   long division with N + 1 quotient digits
+//    sqrt  argument scaled by an even power of two, Newton iteration for
+//          sqrt(a) from the f64 square root with f64 corrections
+//
+//  All results are renormalized once from N + 1 words.
+//
+//  ex_add(a, b) etc. select the tuned kernels of f64fnc.h (N = 2) and
+//  f128fnc.h (N = 4) by overloading. The generic version is always available
+//  with explicit template arguments, e.g. ex_add<4>(a, b).
+//
+//  ns/call and minimum correct bits on the host (x86 without FMA, -O2,
+//  Host/Benchmarks/bench_expansion.cpp):
+//
+//             add generic   add tuned   mul generic   mul tuned   bits
+//    N = 2        5.3          3.8         14.4          4.1       48
+//    N = 3        9.9           -          50.9           -        73
+//    N = 4       24.9         20.6         90.4         73.4       98
+//
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __EXPANSION_H
+#define __EXPANSION_H
+
+#include "f128.h"
+
+using namespace metal;
+
+
+// Struct for N-term expansions
+template <int N>
+struct expansion {
+    float v[N];
+
+    expansion() {
+        for (int i = 0; i < N; i++) v[i] = 0.0f;
+    }
+
+    expansion(float a) {
+        v[0] = a;
+        for (int i = 1; i < N; i++) v[i] = 0.0f;
+    }
+
+    expansion(int a) {
+        v[0] = float(a);
+        for (int i = 1; i < N; i++) v[i] = 0.0f;
+    }
+
+    // Words beyond N are added to the last word
+    expansion(float4 a) {
+        float w[4] = { a.x, a.y, a.z, a.w };
+        for (int i = 0; i < N; i++) v[i] = i < 4 ? w[i] : 0.0f;
+        for (int i = N; i < 4; i++) v[N - 1] += w[i];
+    }
+
+    expansion(float2 a) : expansion(float4(a, 0.0f, 0.0f)) {
+    }
+
+    expansion(f64 a) : expansion(float4(a.v, 0.0f, 0.0f)) {
+    }
+
+    expansion(f128 a) : expansion(a.v) {
+    }
+
+#ifndef __METAL_VERSION__
+    /// Host only: split a double into 3 parts
+    expansion(double a) {
+        float x = float(a);
+        float y = float(a - double(x));
+        float z = float(a - double(x) - double(y));
+        *this = expansion(float4(x, y, z, 0.0f));
+    }
+#endif
+
+    expansion operator += (expansion a) {
+        *this = ex_add(*this, a);
+        return *this;
+    }
+
+    expansion operator -= (expansion a) {
+        *this = ex_sub(*this, a);
+        return *this;
+    }
+
+    expansion operator *= (expansion a) {
+        *this = ex_mul(*this, a);
+        return *this;
+    }
+
+    expansion operator /= (expansion a) {
+        *this = ex_div(*this, a);
+        return *this;
+    }
+};
+
+// 72 bit float
+typedef expansion<3> f96;
+
+
+// ----------------------------------------------------------------------------
+//  Generic algorithms
+// ----------------------------------------------------------------------------
+
+// Renormalize N + 1 overlapping words to an expansion (see qf_renorm)
+template <int N>
+static inline expansion<N> ex_renorm(expansion<N + 1> c) {
+    expansion<N> r;
+    if (isinf(c.v[0])) {
+        for (int i = 0; i < N; i++) r.v[i] = c.v[i];
+        return r;
+    }
+
+    // Bottom up, the lower words may be out of order after cancellation
+    float s = c.v[N];
+    for (int i = N - 1; i > 0; i--) {
+        float2 t = two_sum(c.v[i], s);
+        s = t.x;
+        c.v[i + 1] = t.y;
+    }
+    float2 t = quick_two_sum(c.v[0], s);
+    c.v[0] = t.x;
+    c.v[1] = t.y;
+
+    // Top down
+    s = c.v[0];
+    for (int i = 1; i < N; i++) {
+        t = quick_two_sum(s, c.v[i]);
+        r.v[i - 1] = t.x;
+        s = t.y;
+    }
+    r.v[N - 1] = s + c.v[N];
+
+    return r;
+}
+
+// Add two expansions
+template <int N>
+static inline expansion<N> ex_add(expansion<N> a, expansion<N> b) {
+    // Errors of the previous order, k of order k
+    expansion<N + 1> c;
+    float e[N];
+
+    for (int k = 0; k < N; k++) {
+        // a[k] + b[k] + errors of order k, the new errors replace them
+        float2 t = two_sum(a.v[k], b.v[k]);
+        float x = t.x;
+        float f = t.y;
+        for (int i = 0; i < k; i++) {
+            t = two_sum(x, e[i]);
+            x = t.x;
+            e[i] = t.y;
+        }
+        e[k] = f;
+        c.v[k] = x;
+    }
+
+    // Order N
+    float r = e[0];
+    for (int i = 1; i < N; i++) r += e[i];
+    c.v[N] = r;
+
+    return ex_renorm<N>(c);
+}
+
+template <int N>
+static inline expansion<N> ex_neg(expansion<N> a) {
+    for (int i = 0; i < N; i++) a.v[i] = -a.v[i];
+    return a;
+}
+
+template <int N>
+static inline expansion<N> ex_sub(expansion<N> a, expansion<N> b) {
+    return ex_add<N>(a, ex_neg<N>(b));
+}
+
+// Multiply two expansions
+template <int N>
+static inline expansion<N> ex_mul(expansion<N> a, expansion<N> b) {
+    // Errors of the previous order, k^2 of order k
+    expansion<N + 1> c;
+    float e[N * N];
+
+    for (int k = 0; k < N; k++) {
+        // Errors of order k, the new errors replace them
+        const int m = k * k;
+        float2 p = two_prod(a.v[0], b.v[k]);
+        float x = p.x;
+        for (int i = 0; i < m; i++) {
+            float2 t = two_sum(x, e[i]);
+            x = t.x;
+            e[i] = t.y;
+        }
+        e[m] = p.y;
+
+        // Products of order k, their errors are of order k + 1
+        for (int j = 1; j <= k; j++) {
+            float2 q = two_prod(a.v[j], b.v[k - j]);
+            float2 t = two_sum(x, q.x);
+            x = t.x;
+            e[m + 2 * j - 1] = t.y;
+            e[m + 2 * j] = q.y;
+        }
+        c.v[k] = x;
+    }
+
+    // Order N: products and errors as plain floats
+    float r = 0.0f;
+    for (int i = 1; i < N; i++) r += a.v[i] * b.v[N - i];
+    for (int i = 0; i < N * N; i++) r += e[i];
+    c.v[N] = r;
+
+    return ex_renorm<N>(c);
+}
+
+// Multiply expansion by float
+template <int N>
+static inline expansion<N> ex_mul_f(expansion<N> a, float b) {
+    // Errors of the previous order, k of order k
+    expansion<N + 1> c;
+    float e[N];
+
+    for (int k = 0; k < N; k++) {
+        float2 p = two_prod(a.v[k], b);
+        float x = p.x;
+        for (int i = 0; i < k; i++) {
+            float2 t = two_sum(x, e[i]);
+            x = t.x;
+            e[i] = t.y;
+        }
+        e[k] = p.y;
+        c.v[k] = x;
+    }
+
+    float r = e[0];
+    for (int i = 1; i < N; i++) r += e[i];
+    c.v[N] = r;
+
+    return ex_renorm<N>(c);
+}
+
+template <int N>
+static inline expansion<N> ex_sqr(expansion<N> a) {
+    return ex_mul<N>(a, a);
+}
+
+// Division: long division with N + 1 quotient digits
+template <int N>
+static inline expansion<N> ex_div(expansion<N> a, expansion<N> b) {
+    expansion<N + 1> q;
+    expansion<N> r = a;
+    for (int i = 0; i < N; i++) {
+        q.v[i] = r.v[0] / b.v[0];
+        r = ex_sub<N>(r, ex_mul_f<N>(b, q.v[i]));
+    }
+    q.v[N] = r.v[0] / b.v[0];
+    return ex_renorm<N>(q);
+}
+
+// a * 2^k, |k| <= 252, exact if the words stay normal
+template <int N>
+static inline expansion<N> ex_scale(expansion<N> a, int k) {
+    int k1 = k / 2;
+    float s1 = as_type<float>(uint(k1 + 127) << 23), s2 = as_type<float>(uint(k - k1 + 127) << 23);
+    for (int i = 0; i < N; i++) a.v[i] = a.v[i] * s1 * s2;
+    return a;
+}
+
+// Square root
+// a = b * 2^2k with 1 <= b < 4 keeps the lower words of the squares normal.
+// Newton iteration y = y + (b - y^2) / 2y from the f64 square root, the
+// correction has half the bits of the result and is divided in f64
+template <int N>
+static inline expansion<N> ex_sqrt(expansion<N> a) {
+    if (a.v[0] == 0.0f) return expansion<N>();
+    if (a.v[0] < 0.0f) return expansion<N>(NAN);
+    if (isinf(a.v[0])) return a;
+
+    int k = qf_ilogb(a.v[0]) >> 1;
+    expansion<N> b = ex_scale<N>(a, -2 * k);
+
+    // sqrt_f64() has at least 46 bits, each step adds min(bits, 46)
+    expansion<N> y = expansion<N>(sqrt_f64(float2(b.v[0], b.v[1])));
+    for (int bits = 46; bits < 24 * N + 2; bits += 46) {
+        expansion<N> r = ex_sub<N>(b, ex_sqr<N>(y));
+        y = ex_add<N>(y, expansion<N>(div_f64(float2(r.v[0], r.v[1]), float2(y.v[0], y.v[1]) * 2.0f)));
+    }
+
+    return ex_scale<N>(y, k);
+}
+
+// Equal (normalized values)
+template <int N>
+static inline bool ex_eq(expansion<N> a, expansion<N> b) {
+    for (int i = 0; i < N; i++) {
+        if (a.v[i] != b.v[i]) return false;
+    }
+    return true;
+}
+
+// Less than (normalized values)
+template <int N>
+static inline bool ex_lt(expansion<N> a, expansion<N> b) {
+    for (int i = 0; i < N; i++) {
+        if (a.v[i] != b.v[i]) return a.v[i] < b.v[i];
+    }
+    return false;
+}
+
+
+// ----------------------------------------------------------------------------
+//  Tuned kernels for N = 2 and N = 4
+// ----------------------------------------------------------------------------
+
+static inline float2 ex_f2(expansion<2> a) {
+    return float2(a.v[0], a.v[1]);
+}
+
+static inline float4 ex_f4(expansion<4> a) {
+    return float4(a.v[0], a.v[1], a.v[2], a.v[3]);
+}
+
+static inline expansion<2> ex_add(expansion<2> a, expansion<2> b) { return expansion<2>(add_f64(ex_f2(a), ex_f2(b))); }
+static inline expansion<2> ex_sub(expansion<2> a, expansion<2> b) { return expansion<2>(sub_f64(ex_f2(a), ex_f2(b))); }
+static inline expansion<2> ex_mul(expansion<2> a, expansion<2> b) { return expansion<2>(mul_f64(ex_f2(a), ex_f2(b))); }
+static inline expansion<2> ex_mul_f(expansion<2> a, float b) { return expansion<2>(mul_f64(ex_f2(a), flt2(b))); }
+static inline expansion<2> ex_sqr(expansion<2> a) { return expansion<2>(sqr_f64(ex_f2(a))); }
+static inline expansion<2> ex_div(expansion<2> a, expansion<2> b) { return expansion<2>(div_f64(ex_f2(a), ex_f2(b))); }
+static inline expansion<2> ex_sqrt(expansion<2> a) { return expansion<2>(sqrt_f64(ex_f2(a))); }
+
+static inline expansion<4> ex_add(expansion<4> a, expansion<4> b) { return expansion<4>(qf_add(ex_f4(a), ex_f4(b))); }
+static inline expansion<4> ex_sub(expansion<4> a, expansion<4> b) { return expansion<4>(qf_sub(ex_f4(a), ex_f4(b))); }
+static inline expansion<4> ex_mul(expansion<4> a, expansion<4> b) { return expansion<4>(qf_mul(ex_f4(a), ex_f4(b))); }
+static inline expansion<4> ex_mul_f(expansion<4> a, float b) { return expansion<4>(qf_mul_f(ex_f4(a), b)); }
+static inline expansion<4> ex_sqr(expansion<4> a) { return expansion<4>(qf_sqr(ex_f4(a))); }
+static inline expansion<4> ex_div(expansion<4> a, expansion<4> b) { return expansion<4>(qf_div(ex_f4(a), ex_f4(b))); }
+static inline expansion<4> ex_sqrt(expansion<4> a) { return expansion<4>(qf_sqrt(ex_f4(a))); }
+
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+
+/// Convert expansion to f64
+template <int N>
+static inline f64 dbl(expansion<N> a) {
+    float lo = 0.0f;
+    for (int i = N - 1; i > 0; i--) lo += a.v[i];
+    return f64(sumq(a.v[0], lo));
+}
+
+/// Convert expansion to f128
+template <int N>
+static inline f128 to_f128(expansion<N> a) {
+    float w[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < N; i++) w[i < 4 ? i : 3] += a.v[i];
+    return f128(float4(w[0], w[1], w[2], w[3]));
+}
+
+/// Convert expansion to float
+template <int N>
+static inline float flt(expansion<N> a) {
+    return a.v[0];
+}
+
+/// Minimum of two values
+template <int N>
+static inline expansion<N> min(expansion<N> a, expansion<N> b) {
+    return ex_lt(b, a) ? b : a;
+}
+
+/// Maximum of two values
+template <int N>
+static inline expansion<N> max(expansion<N> a, expansion<N> b) {
+    return ex_lt(a, b) ? b : a;
+}
+
+// Absolute value
+template <int N>
+static inline expansion<N> abs(expansion<N> a) {
+    return a.v[0] < 0.0f ? ex_neg(a) : a;
+}
+
+/// Square
+template <int N>
+static inline expansion<N> sqr(expansion<N> a) {
+    return ex_sqr(a);
+}
+
+/// Square root
+template <int N>
+static inline expansion<N> sqrt(expansion<N> a) {
+    return ex_sqrt(a);
+}
+
+
+// ----------------------------------------------------------------------------
+//  Overloaded operators
+//
+//  Other operands (float, f64, f128) are converted to expansion<N>
+// ----------------------------------------------------------------------------
+
+template <int N>
+static inline expansion<N> operator - (expansion<N> a) {
+    return ex_neg(a);
+}
+
+template <int N>
+static inline expansion<N> operator + (expansion<N> a, expansion<N> b) {
+    return ex_add(a, b);
+}
+
+template <int N>
+static inline expansion<N> operator - (expansion<N> a, expansion<N> b) {
+    return ex_sub(a, b);
+}
+
+template <int N>
+static inline expansion<N> operator * (expansion<N> a, expansion<N> b) {
+    return ex_mul(a, b);
+}
+
+template <int N>
+static inline expansion<N> operator * (expansion<N> a, float b) {
+    return ex_mul_f(a, b);
+}
+
+template <int N>
+static inline expansion<N> operator * (float a, expansion<N> b) {
+    return ex_mul_f(b, a);
+}
+
+template <int N>
+static inline expansion<N> operator / (expansion<N> a, expansion<N> b) {
+    return ex_div(a, b);
+}
+
+#define METAL64_EX_OPERATOR(OP, T)                                                                  \
+template <int N>                                                                                    \
+static inline expansion<N> operator OP (expansion<N> a, T b) {                                      \
+    return a OP expansion<N>(b);                                                                    \
+}                                                                                                   \
+template <int N>                                                                                    \
+static inline expansion<N> operator OP (T a, expansion<N> b) {                                      \
+    return expansion<N>(a) OP b;                                                                    \
+}
+
+METAL64_EX_OPERATOR(+, float)
+METAL64_EX_OPERATOR(-, float)
+METAL64_EX_OPERATOR(/, float)
+METAL64_EX_OPERATOR(+, f64)
+METAL64_EX_OPERATOR(-, f64)
+METAL64_EX_OPERATOR(*, f64)
+METAL64_EX_OPERATOR(/, f64)
+
+#undef METAL64_EX_OPERATOR
+
+template <int N>
+static inline bool operator == (expansion<N> a, expansion<N> b) {
+    return ex_eq(a, b);
+}
+
+template <int N>
+static inline bool operator != (expansion<N> a, expansion<N> b) {
+    return !ex_eq(a, b);
+}
+
+template <int N>
+static inline bool operator < (expansion<N> a, expansion<N> b) {
+    return ex_lt(a, b);
+}
+
+template <int N>
+static inline bool operator > (expansion<N> a, expansion<N> b) {
+    return ex_lt(b, a);
+}
+
+template <int N>
+static inline bool operator <= (expansion<N> a, expansion<N> b) {
+    return !ex_lt(b, a);
+}
+
+template <int N>
+static inline bool operator >= (expansion<N> a, expansion<N> b) {
+    return !ex_lt(a, b);
+}
+
+#endif
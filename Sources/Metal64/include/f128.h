@@ -0,0 +1,278 @@
+//
+//  f128.h
+//
+//  Part of Metal64
+//
+//  Implementation of datatype f128
+//
+//  Mandatory Xcode build settings:
+//
+//    Metal Compiler - Build Options - Math Mode = "Safe"
+//    User Defined - MTL_FAST_MATH = "NO"
+//
+//  Created by Dirk Braner on 19.04.26.
+//
+
+#ifndef __F128_H
+#define __F128_H
+
+#ifdef __METAL_VERSION__
+#include <metal_stdlib>
+#else
+#include "metal_host.h"
+#endif
+
+#include "f64.h"
+#include "f128fnc.h"
+#include "f128poly.h"
+
+
+using namespace metal;
+
+// Struct for 128 bit floating points
+struct f128 {
+    float4 v;
+    
+    f128() {
+        v = float4(0.0f);
+    }
+    
+    f128(float a) {
+        v = float4(a, 0.0f, 0.0f, 0.0f);
+    }
+    
+    f128(int a) {
+        v = float4(float(a), 0.0f, 0.0f, 0.0f);
+    }
+    
+    f128(float2 a) {
+        v = float4(a, 0.0f, 0.0f);
+    }
+    
+    f128(f64 a) {
+        v = float4(a.v, 0.0f, 0.0f);
+    }
+    
+    f128(float4 a) {
+        v = a;
+    }
+    
+#ifndef __METAL_VERSION__
+    /// Host only: split a double into 3 parts
+    f128(double a) {
+        float x = float(a);
+        float y = float(a - double(x));
+        float z = float(a - double(x) - double(y));
+        v = float4(x, y, z, 0.0f);
+    }
+#endif
+    
+    f128 operator = (float a) {
+        v = float4(a, 0.0f, 0.0f, 0.0f);
+        return *this;
+    }
+    
+    f128 operator = (f64 a) {
+        v = float4(a.v, 0.0f, 0.0f);
+        return *this;
+    }
+    
+    f128 operator += (f128 a) {
+        v = qf_add(v, a.v);
+        return *this;
+    }
+    
+    f128 operator -= (f128 a) {
+        v = qf_sub(v, a.v);
+        return *this;
+    }
+    
+    f128 operator *= (f128 a) {
+        v = qf_mul(v, a.v);
+        return *this;
+    }
+    
+    f128 operator /= (f128 a) {
+        v = qf_div(v, a.v);
+        return *this;
+    }
+};
+
+/// Convert f128 to f64
+static inline f64 dbl(f128 a) {
+    return f64(sumq(a.v.x, a.v.y + a.v.z));
+}
+
+/// Convert f128 to float
+static inline float flt(f128 a) {
+    return a.v.x;
+}
+
+/// Minimum of two values
+static inline f128 min(f128 a, f128 b) {
+    return qf_lt(b.v, a.v) ? b : a;
+}
+
+/// Maximum of two values
+static inline f128 max(f128 a, f128 b) {
+    return qf_lt(a.v, b.v) ? b : a;
+}
+
+// Absolute value
+static inline f128 abs(f128 a) {
+    return a.v.x < 0.0f ? f128(-a.v) : a;
+}
+
+// Floor
+static inline f128 floor(f128 a) {
+    return f128(qf_floor(a.v));
+}
+
+/// Square
+static inline f128 sqr(f128 a) {
+    return f128(qf_sqr(a.v));
+}
+
+/// Square root
+static inline f128 sqrt(f128 a) {
+    return f128(qf_sqrt(a.v));
+}
+
+// Exponential function
+static inline f128 exp(f128 a) {
+    return f128(qf_exp(a.v));
+}
+
+// Natural logarithm
+static inline f128 log(f128 a) {
+    return f128(qf_log(a.v));
+}
+
+// Power, exponent = f128
+static inline f128 pow(f128 a, f128 b) {
+    return f128(qf_exp(qf_mul(b.v, qf_log(a.v))));
+}
+
+// Overloaded operators
+
+static inline f128 operator - (f128 a) {
+    return f128(-a.v);
+}
+
+static inline f128 operator + (f128 a, f128 b) {
+    return f128(qf_add(a.v, b.v));
+}
+
+static inline f128 operator + (f128 a, f64 b) {
+    return f128(qf_add(a.v, float4(b.v, 0.0f, 0.0f)));
+}
+
+static inline f128 operator + (f64 b, f128 a) {
+    return f128(qf_add(a.v, float4(b.v, 0.0f, 0.0f)));
+}
+
+static inline f128 operator + (f128 a, float b) {
+    return f128(qf_add(a.v, float4(b, 0.0f, 0.0f, 0.0f)));
+}
+
+static inline f128 operator + (float b, f128 a) {
+    return f128(qf_add(a.v, float4(b, 0.0f, 0.0f, 0.0f)));
+}
+
+static inline f128 operator - (f128 a, f128 b) {
+    return f128(qf_sub(a.v, b.v));
+}
+
+static inline f128 operator - (f128 a, f64 b) {
+    return f128(qf_sub(a.v, float4(b.v, 0.0f, 0.0f)));
+}
+
+static inline f128 operator - (f64 a, f128 b) {
+    return f128(qf_sub(float4(a.v, 0.0f, 0.0f), b.v));
+}
+
+static inline f128 operator - (f128 a, float b) {
+    return f128(qf_sub(a.v, float4(b, 0.0f, 0.0f, 0.0f)));
+}
+
+static inline f128 operator - (float a, f128 b) {
+    return f128(qf_sub(float4(a, 0.0f, 0.0f, 0.0f), b.v));
+}
+
+static inline f128 operator * (f128 a, f128 b) {
+    return f128(qf_mul(a.v, b.v));
+}
+
+static inline f128 operator * (f128 a, f64 b) {
+    return f128(qf_mul(a.v, float4(b.v, 0.0f, 0.0f)));
+}
+
+static inline f128 operator * (f64 a, f128 b) {
+    return f128(qf_mul(b.v, float4(a.v, 0.0f, 0.0f)));
+}
+
+static inline f128 operator * (f128 a, float b) {
+    return f128(qf_mul_f(a.v, b));
+}
+
+static inline f128 operator * (float a, f128 b) {
+    return f128(qf_mul_f(b.v, a));
+}
+
+static inline f128 operator / (f128 a, f128 b) {
+    return f128(qf_div(a.v, b.v));
+}
+
+static inline f128 operator / (f128 a, f64 b) {
+    return f128(qf_div(a.v, float4(b.v, 0.0f, 0.0f)));
+}
+
+static inline f128 operator / (f64 a, f128 b) {
+    return f128(qf_div(float4(a.v, 0.0f, 0.0f), b.v));
+}
+
+static inline f128 operator / (f128 a, float b) {
+    return f128(qf_div(a.v, float4(b, 0.0f, 0.0f, 0.0f)));
+}
+
+static inline f128 operator / (float a, f128 b) {
+    return f128(qf_div(float4(a, 0.0f, 0.0f, 0.0f), b.v));
+}
+
+static inline bool operator == (f128 a, f128 b) {
+    return qf_eq(a.v, b.v);
+}
+
+static inline bool operator != (f128 a, f128 b) {
+    return !qf_eq(a.v, b.v);
+}
+
+static inline bool operator < (f128 a, f128 b) {
+    return qf_lt(a.v, b.v);
+}
+
+static inline bool operator > (f128 a, f128 b) {
+    return qf_gt(a.v, b.v);
+}
+
+static inline bool operator <= (f128 a, f128 b) {
+    return qf_le(a.v, b.v);
+}
+
+static inline bool operator >= (f128 a, f128 b) {
+    return qf_ge(a.v, b.v);
+}
+
+static inline bool isZero(f128 a) {
+    return all(a.v == 0.0f);
+}
+
+static inline bool notZero(f128 a) {
+    return any(a.v != 0.0f);
+}
+
+static inline int sign(f128 a) {
+    return qf_sign(a.v);
+}
+
+#endif
@@ -1,7 +1,20 @@
 //
-//  f128.h
+//  f128fnc.h
 //  Metal64
 //
+//  128 bit float:
+//
+//    A 128 bit float value is represented by float4 data type.
+//      .x = Highest value part
+//      .w = Lowest value part
+//
+//  References:
+//
+//    "Library for Double-Double and Quad-Double Arithmetic"
+//    Yozo Hida, Xiaoye S. Li, David H. Bailey
+//
+//  Requires f64fnc.h
+//
 //  Created by Dirk Braner on 12.04.26.
 //
 
@@ -10,108 +23,291 @@
 
 using namespace metal;
 
+// The error-free transformations two_sum, quick_two_sum and two_prod are
+// defined in f64fnc.h
 
-// Calculate s = a + b and error e
-static inline float2 two_sum(float a, float b) {
-    float s = a + b;
-    float v = s - a;
-    float e = (a - (s - v)) + (b - v);
-    return float2(s, e);
+// Sum of three floats: float4(s, e1, e2, 0)
+static inline float4 three_sum(float a, float b, float c) {
+    float2 t1 = two_sum(a, b);
+    float2 t2 = two_sum(c, t1.x);
+    float2 t3 = two_sum(t1.y, t2.y);
+    return float4(t2.x, t3.x, t3.y, 0.0f);
 }
 
-// Quick version of two_sum if |a| >= |b|
-static inline float2 quick_two_sum(float a, float b) {
-    float s = a + b;
-    float e = b - (s - a);
-    return float2(s, e);
+// Sum of three floats, error of 2nd order is rounded: float2(s, e)
+static inline float2 three_sum2(float a, float b, float c) {
+    float2 t1 = two_sum(a, b);
+    float2 t2 = two_sum(c, t1.x);
+    return float2(t2.x, t1.y + t2.y);
 }
 
-static float4 qf_add(float4 a, float4 b) {
-    float2 s;
-    float4 r;
+// Renormalize 5 overlapping floats to a quad float
+static inline float4 qf_renorm(float4 c, float c4) {
+    if (isinf(c.x)) return c;
 
-    s = two_sum(a.x, b.x);
-    r.x = s.x;
-    
-    s = two_sum(a.y, b.y + s.y);
-    r.y = s.x;
-    
-    s = two_sum(a.z, b.z + s.y);
-    r.z = s.x;
-    
-    r.w = a.w + b.w + s.y;
-    
-    s = quick_two_sum(r.x, r.y);
+    // Bottom up, the lower words may be out of order after cancellation
+    float2 s = two_sum(c.w, c4);
+    c4 = s.y;
+    s = two_sum(c.z, s.x);
+    c.w = s.y;
+    s = two_sum(c.y, s.x);
+    c.z = s.y;
+    s = quick_two_sum(c.x, s.x);
+    c.y = s.y;
+    c.x = s.x;
+
+    // Top down
+    float4 r;
+    s = quick_two_sum(c.x, c.y);
     r.x = s.x;
-    s = quick_two_sum(s.y, r.z);
+    s = quick_two_sum(s.y, c.z);
     r.y = s.x;
-    s = quick_two_sum(s.y, r.w);
+    s = quick_two_sum(s.y, c.w);
     r.z = s.x;
-    r.w = s.y;
+    r.w = s.y + c4;
 
     return r;
 }
 
+// Add 2 quad floats
+static inline float4 qf_add(float4 a, float4 b) {
+    float2 s0 = two_sum(a.x, b.x);
+    float2 s1 = two_sum(a.y, b.y);
+    float2 s2 = two_sum(a.z, b.z);
+    float2 s3 = two_sum(a.w, b.w);
+
+    float2 t = two_sum(s1.x, s0.y);
+    float4 u = three_sum(s2.x, t.y, s1.y);
+    float2 v = three_sum2(s3.x, u.y, s2.y);
+
+    return qf_renorm(float4(s0.x, t.x, u.x, v.x), v.y + u.z + s3.y);
+}
+
 static inline float4 qf_sub(float4 a, float4 b) {
     return qf_add(a, b * -1.0f);
 }
 
-// Split float into 2 parts
-static inline float2 split(float a) {
-    float t = a * ((1 << 12) + 1);
-    float a_hi = t - (t - a);
-    float a_lo = a - a_hi;
-    return float2(a_hi, a_lo);
+// Multiplication of quad floats
+// The partial products are collected by order of magnitude (eps = 2^-24) with
+// three-sum / six-sum networks and renormalized once at the end.
+// All 16 partial products are included: 192 flops with an fma based two_prod,
+// more than the previous qf_mul (68, 3 products) and qf_mulopt (167, 6
+// products). The extra flops buy accuracy, min. 99 bits instead of 47 / 71.
+// The networks are shallower than one qf_add per product, on the host it is
+// still about 2x faster than the previous qf_mulopt (bench_qfmul.cpp).
+// qf_mul_sloppy: 130 flops, min. 94 bits.
+static inline float4 qf_mul(float4 a, float4 b) {
+    // O(1), O(eps), O(eps^2) terms
+    float2 p0 = two_prod(a.x, b.x);
+    float2 p1 = two_prod(a.x, b.y);
+    float2 p2 = two_prod(a.y, b.x);
+    float2 p3 = two_prod(a.x, b.z);
+    float2 p4 = two_prod(a.y, b.y);
+    float2 p5 = two_prod(a.z, b.x);
+
+    // O(eps): p1 + p2 + error of p0
+    float4 t = three_sum(p1.x, p2.x, p0.y);
+
+    // O(eps^2): six-three sum of the errors of p1 + p2 + p3 + p4 + p5
+    float4 u = three_sum(t.y, p1.y, p2.y);
+    float4 v = three_sum(p3.x, p4.x, p5.x);
+    float2 s0 = two_sum(u.x, v.x);
+    float2 s1 = two_sum(u.y, v.y);
+    float s2 = u.z + v.z;
+    float2 s3 = two_sum(s1.x, s0.y);
+    s2 += s3.y + s1.y;
+
+    // O(eps^3): nine-two sum of the exact order 3 products and the errors of p3 + p4 + p5
+    float2 p6 = two_prod(a.x, b.w);
+    float2 p7 = two_prod(a.y, b.z);
+    float2 p8 = two_prod(a.z, b.y);
+    float2 p9 = two_prod(a.w, b.x);
+
+    float2 q0 = two_sum(t.z, p3.y);
+    float2 q1 = two_sum(p4.y, p5.y);
+    float2 q2 = two_sum(p6.x, p7.x);
+    float2 q3 = two_sum(p8.x, p9.x);
+
+    float2 r0 = two_sum(q0.x, q1.x);
+    r0.y += q0.y + q1.y;
+    float2 r1 = two_sum(q2.x, q3.x);
+    r1.y += q2.y + q3.y;
+    float2 r2 = two_sum(r0.x, r1.x);
+    r2.y += r0.y + r1.y;
+    float2 r3 = two_sum(r2.x, s3.x);
+    r3.y += r2.y;
+
+    // O(eps^4): nine-one sum
+    r3.y += a.y * b.w + a.z * b.z + a.w * b.y + p6.y + p7.y + p8.y + p9.y + s2;
+
+    return qf_renorm(float4(p0.x, t.x, s0.x, r3.x), r3.y);
 }
 
-// Exact multiplication of 2 floats
-static inline float2 two_prod(float a, float b) {
-    float x = a * b;
-    float2 a_s = split(a);
-    float2 b_s = split(b);
-    float err = ((a_s.x * b_s.x - x) + a_s.x * b_s.y + a_s.y * b_s.x) + a_s.y * b_s.y;
-    return float2(x, err);
+// Sloppy multiplication, error about 2 ulp
+// O(eps^3) terms are summed as plain floats, O(eps^4) terms are dropped
+static inline float4 qf_mul_sloppy(float4 a, float4 b) {
+    // O(1), O(eps), O(eps^2) terms
+    float2 p0 = two_prod(a.x, b.x);
+    float2 p1 = two_prod(a.x, b.y);
+    float2 p2 = two_prod(a.y, b.x);
+    float2 p3 = two_prod(a.x, b.z);
+    float2 p4 = two_prod(a.y, b.y);
+    float2 p5 = two_prod(a.z, b.x);
+
+    // O(eps): p1 + p2 + error of p0
+    float4 t = three_sum(p1.x, p2.x, p0.y);
+
+    // O(eps^2): six-three sum of the errors of p1 + p2 + p3 + p4 + p5
+    float4 u = three_sum(t.y, p1.y, p2.y);
+    float4 v = three_sum(p3.x, p4.x, p5.x);
+    float2 s0 = two_sum(u.x, v.x);
+    float2 s1 = two_sum(u.y, v.y);
+    float s2 = u.z + v.z;
+    float2 s3 = two_sum(s1.x, s0.y);
+    s2 += s3.y + s1.y;
+
+    // O(eps^3) terms
+    s3.x += a.x * b.w + a.y * b.z + a.z * b.y + a.w * b.x + t.z + p3.y + p4.y + p5.y;
+
+    return qf_renorm(float4(p0.x, t.x, s0.x, s3.x), s2);
 }
 
-static float4 qf_mul(float4 a, float4 b) {
-    float2 p;
+// Kept for source compatibility, qf_mul includes all terms
+static inline float4 qf_mulopt(float4 a, float4 b) {
+    return qf_mul(a, b);
+}
 
-    p = two_prod(a.x, b.x);
-    float4 r = float4(p.x, p.y, 0.0, 0.0);
+// Multiply quad float by float
+static inline float4 qf_mul_f(float4 a, float b) {
+    float2 p0 = two_prod(a.x, b);
+    float2 p1 = two_prod(a.y, b);
+    float2 p2 = two_prod(a.z, b);
+    float p3 = a.w * b;
 
-    p = two_prod(a.x, b.y);
-    r = qf_add(r, float4(0, p.x, p.y, 0));
-    
-    p = two_prod(a.y, b.x);
-    r = qf_add(r, float4(0, p.x, p.y, 0));
+    float2 s1 = two_sum(p0.y, p1.x);
+    float4 u = three_sum(s1.y, p1.y, p2.x);
+    float2 v = three_sum2(u.y, p2.y, p3);
 
-    return r;
+    return qf_renorm(float4(p0.x, s1.x, u.x, v.x), v.y + u.z);
+}
+
+// Square of quad float
+static inline float4 qf_sqr(float4 a) {
+    return qf_mul(a, a);
 }
 
-static float4 qf_mulopt(float4 a, float4 b) {
-    float2 p;
+// Division: long division with 5 quotient digits
+// The remainder is scaled by 2^24 after every digit, so its lower words do not
+// fall below the float range (subnormal, slow on the host, flushed on the GPU)
+static inline float4 qf_div(float4 a, float4 b) {
+    const float up = 16777216.0f;              // 2^24
+    const float down = 5.9604644775390625e-8f; // 2^-24
 
-    p = two_prod(a.x, b.x);
-    float4 r = float4(p.x, p.y, 0.0, 0.0);
+    float q0 = a.x / b.x;
+    float4 r = qf_sub(a, qf_mul_f(b, q0)) * up;
 
-    p = two_prod(a.x, b.y);
-    r = qf_add(r, float4(0, p.x, p.y, 0));
-    
-    p = two_prod(a.y, b.x);
-    r = qf_add(r, float4(0, p.x, p.y, 0));
+    float q1 = r.x / b.x;
+    r = qf_sub(r, qf_mul_f(b, q1)) * up;
 
-    p = two_prod(a.x, b.z);
-    r = qf_add(r, float4(0, 0, p.x, p.y));
-    
-    p = two_prod(a.z, b.x);
-    r = qf_add(r, float4(0, 0, p.x, p.y));
-    
-    p = two_prod(a.y, b.y);
-    r = qf_add(r, float4(0, 0, p.x, p.y));
+    float q2 = r.x / b.x;
+    r = qf_sub(r, qf_mul_f(b, q2)) * up;
+
+    float q3 = r.x / b.x;
+    r = qf_sub(r, qf_mul_f(b, q3)) * up;
+
+    float q4 = r.x / b.x;
+
+    return qf_renorm(float4(q0, q1 * down, q2 * (down * down), q3 * (down * down * down)),
+                     q4 * (down * down * down * down));
+}
+
+// Binary exponent of a normal float: a = f * 2^k, 1 <= |f| < 2
+static inline int qf_ilogb(float a) {
+    return int((as_type<uint>(a) >> 23) & 0xff) - 127;
+}
+
+// a * 2^k, |k| <= 252, exact if the words stay normal
+static inline float4 qf_scale(float4 a, int k) {
+    int k1 = k / 2;
+    return a * as_type<float>(uint(k1 + 127) << 23) * as_type<float>(uint(k - k1 + 127) << 23);
+}
+
+// Square root
+// a = b * 2^2k with 1 <= b < 4 keeps the lower words of the squares normal.
+// Newton steps y = y + (b - y^2) / 2y with doubling precision: f64 square
+// root (48 bits), the correction of the second step in f64 (96 bits), of the
+// last step in float
+static inline float4 qf_sqrt(float4 a) {
+    if (a.x == 0.0f) return float4(0.0f);
+    if (a.x < 0.0f) return float4(NAN);
+    if (isinf(a.x)) return a;
+
+    int k = qf_ilogb(a.x) >> 1;
+    float4 b = qf_scale(a, -2 * k);
+
+    float2 y = sqrt_f64(b.xy);
+    float4 r = qf_sub(b, qf_sqr(float4(y, 0.0f, 0.0f)));
+    float4 x = qf_add(float4(y, 0.0f, 0.0f), float4(div_f64(r.xy, y * 2.0f), 0.0f, 0.0f));
+
+    r = qf_sub(b, qf_sqr(x));
+    x = qf_add(x, float4(r.x / (2.0f * x.x), 0.0f, 0.0f, 0.0f));
+
+    return qf_scale(x, k);
+}
+
+// Floor
+static inline float4 qf_floor(float4 a) {
+    float4 r = float4(floor(a.x), 0.0f, 0.0f, 0.0f);
+
+    if (r.x == a.x) {
+        r.y = floor(a.y);
+        if (r.y == a.y) {
+            r.z = floor(a.z);
+            if (r.z == a.z) {
+                r.w = floor(a.w);
+            }
+        }
+        return qf_renorm(r, 0.0f);
+    }
 
     return r;
 }
 
+// ----------------------------------------------------------------------------
+// Compare two quad floats (normalized values)
+// ----------------------------------------------------------------------------
+
+// Equal
+static inline bool qf_eq(float4 a, float4 b) {
+    return all(a == b);
+}
+
+// Less than
+static inline bool qf_lt(float4 a, float4 b) {
+    return a.x < b.x || (a.x == b.x && (a.y < b.y || (a.y == b.y && (a.z < b.z || (a.z == b.z && a.w < b.w)))));
+}
+
+// Greater than
+static inline bool qf_gt(float4 a, float4 b) {
+    return qf_lt(b, a);
+}
+
+// Less or equal, false for NaN
+static inline bool qf_le(float4 a, float4 b) {
+    return qf_lt(a, b) || qf_eq(a, b);
+}
+
+// Greater or equal, false for NaN
+static inline bool qf_ge(float4 a, float4 b) {
+    return qf_lt(b, a) || qf_eq(a, b);
+}
+
+// Return sign of value: -1: <0, 0: =0, 1: >0
+static inline int qf_sign(float4 a) {
+    if (a.x != 0.0f) return a.x < 0.0f ? -1 : 1;
+    return all(a == 0.0f) ? 0 : (qf_lt(a, float4(0.0f)) ? -1 : 1);
+}
+
 
 #endif
 
@@ -0,0 +1,90 @@
+//
+//  f128poly.h
+//
+//  Part of Metal64
+//
+//  Exponential function and logarithm for 128 bit floats
+//
+//  Requires f64.h and f128fnc.h
+//
+//  Created by Dirk Braner on 19.04.26.
+//
+
+#ifndef __F128POLY_H
+#define __F128POLY_H
+
+using namespace metal;
+
+
+// Inverse factorials 1/3! .. 1/9!
+static constant int QF_INV_FACT_LENGTH = 7;
+static constant float4 qf_inv_fact[QF_INV_FACT_LENGTH] = {
+    float4(0.16666667, -4.967054e-09, 1.4802974e-16, -4.41163e-24),         // 1/3!
+    float4(0.041666668, -1.2417635e-09, 3.7007435e-17, -1.1029075e-24),     // 1/4!
+    float4(0.008333334, -4.346172e-10, 1.8503718e-18, -9.6504405e-26),      // 1/5!
+    float4(0.0013888889, -3.3631094e-11, 1.4648776e-18, -1.6084068e-26),    // 1/6!
+    float4(0.0001984127, -2.7255969e-12, 5.438221e-20, -3.2209166e-27),     // 1/7!
+    float4(2.4801588e-05, -3.406996e-13, 6.797776e-21, -4.0261457e-28),     // 1/8!
+    float4(2.7557319e-06, 3.7935712e-14, 1.5082265e-21, 4.5019888e-29)      // 1/9!
+};
+
+// exp(1024 * r) - 1 for |r| <= LOG(2) / 2048
+static inline float4 qf_expm1_kernel(float4 r) {
+    // exp(r) - 1 = r + r^2 * (1/2 + r * (1/3! + r * (... + r * 1/9!)))
+    float4 p = qf_inv_fact[QF_INV_FACT_LENGTH - 1];
+    for (int i = QF_INV_FACT_LENGTH - 2; i >= 0; i--) {
+        p = qf_add(qf_inv_fact[i], qf_mul(r, p));
+    }
+    p = qf_add(float4(0.5f, 0.0f, 0.0f, 0.0f), qf_mul(r, p));
+    float4 s = qf_add(r, qf_mul(qf_sqr(r), p));
+
+    // exp(2r) - 1 = (exp(r) - 1) * (exp(r) + 1)
+    for (int i = 0; i < 10; i++) {
+        s = qf_add(s * 2.0f, qf_sqr(s));
+    }
+
+    return s;
+}
+
+// Exponential function
+// a = m * LOG(2) + 1024 * r  =>  exp(a) = 2^m * exp(r)^1024
+static inline float4 qf_exp(float4 a) {
+    if (isnan(a.x)) return a;
+    if (gt(a.xy, F2_EXPMAX)) return float4(INFINITY, 0.0f, 0.0f, 0.0f);
+    if (lt(a.xy, F2_EXPMIN)) return float4(0.0f);
+
+    float m = rint(a.x * F2_1_LOG2.x);
+    float4 r = qf_sub(a, qf_mul_f(F4_LN2, m)) * (1.0f / 1024.0f);
+
+    float4 s = qf_add(qf_expm1_kernel(r), F4_ONE);
+    int k = int(m);
+    return float4(ldexp(s.x, k), ldexp(s.y, k), ldexp(s.z, k), ldexp(s.w, k));
+}
+
+// Natural logarithm
+// a = m * 2^k, sqrt(1/2) <= m < sqrt(2)  =>  log(a) = log(m) + k * LOG(2)
+// log(m): Newton iteration x = x + m * exp(-x) - 1, starting with the 64 bit
+// logarithm, with the second order term of log(1 + t)
+static inline float4 qf_log(float4 a) {
+    if (qf_eq(a, F4_ONE)) return float4(0.0f);
+    if (a.x <= 0.0f || isinf(a.x) || isnan(a.x)) return float4(log_f64(a.xy), 0.0f, 0.0f);
+
+    int k = qf_ilogb(a.x * 1.4142135f);
+    float4 m = qf_scale(a, -k);
+
+    float4 x = float4(log_f64(m.xy), 0.0f, 0.0f);
+
+    // m * exp(-x) - 1 is small, near 1 use m * (exp(-x) - 1) + (m - 1) to avoid cancellation
+    float4 t;
+    if (abs(x.x) < 0.34f) {
+        t = qf_add(qf_mul(m, qf_expm1_kernel(-x * (1.0f / 1024.0f))), qf_sub(m, F4_ONE));
+    } else {
+        t = qf_sub(qf_mul(m, qf_exp(-x)), F4_ONE);
+    }
+
+    // log(m) = x + log(1 + t) with log(1 + t) = t - t^2 / 2 for the small t
+    float4 r = qf_add(x, qf_add(t, float4(-0.5f * t.x * t.x, 0.0f, 0.0f, 0.0f)));
+    return k == 0 ? r : qf_add(r, qf_mul_f(F4_LN2, float(k)));
+}
+
+#endif
@@ -16,10 +16,16 @@
 #ifndef __F64_H
 #define __F64_H
 
+#ifdef __METAL_VERSION__
 #include <metal_stdlib>
+#else
+#include "metal_host.h"
+#endif
 
 #include "f64fnc.h"
+#include "f64polyeval.h"
 #include "f64iter.h"
+#include "f64poly.h"
 
 
 using namespace metal;
@@ -48,6 +54,14 @@ struct f64 {
         v = float2(float(a), 0.0f);
     }
     
+#ifndef __METAL_VERSION__
+    /// Host only: split a double into high and low part
+    f64(double a) {
+        float hi = float(a);
+        v = float2(hi, float(a - double(hi)));
+    }
+#endif
+    
     f64 operator = (float a) {
         v = float2(a, 0.0f);
         return *this;
@@ -148,52 +162,153 @@ static inline f64 pow(f64 a, int b) {
 
 // Power, exponent = f64
 static inline f64 pow(f64 a, f64 b) {
-    return f64(exp_iterate(mul_f64(b.v, log_iterate(a.v))));
+    return f64(pow_f64(a.v, b.v));
 }
 
 // Exponential function
 static inline f64 exp(f64 a) {
-    return f64(exp_iterate(a.v));
+    return f64(exp_f64(a.v));
 }
 
 // Natural logarithm
 static inline f64 log(f64 a) {
-    return f64(log_iterate(a.v));
+    return f64(log_f64(a.v));
 }
 
 // Sine
 static inline f64 sin(f64 a) {
-    return f64(sincos_iterate(a.v).xy);
+    return f64(sin_f64(a.v));
 }
 
 // Cosine
 static inline f64 cos(f64 a) {
-    return f64(sincos_iterate(a.v).zw);
+    return f64(cos_f64(a.v));
 }
 
 // Tangent
 static inline f64 tan(f64 a) {
-    return f64(tan_iterate(a.v));
+    return f64(tan_f64(a.v));
+}
+
+// Sine and cosine with one argument reduction
+struct f64_sincos {
+    f64 sin;
+    f64 cos;
+};
+
+static inline f64_sincos sincos(f64 a) {
+    float4 sc = sincos_f64(a.v);
+    f64_sincos r;
+    r.sin = f64(sc.xy);
+    r.cos = f64(sc.zw);
+    return r;
+}
+
+// sin(PI * a), exact argument reduction
+static inline f64 sinpi(f64 a) {
+    return f64(sinpi_f64(a.v));
+}
+
+// cos(PI * a), exact argument reduction
+static inline f64 cospi(f64 a) {
+    return f64(cospi_f64(a.v));
+}
+
+// tan(PI * a), exact argument reduction
+static inline f64 tanpi(f64 a) {
+    return f64(tanpi_f64(a.v));
+}
+
+// sin(PI * a) and cos(PI * a)
+static inline f64_sincos sincospi(f64 a) {
+    float4 sc = sincospi_f64(a.v);
+    f64_sincos r;
+    r.sin = f64(sc.xy);
+    r.cos = f64(sc.zw);
+    return r;
+}
+
+// Sine of degrees, exact argument reduction
+static inline f64 sind(f64 a) {
+    return f64(sind_f64(a.v));
+}
+
+// Cosine of degrees, exact argument reduction
+static inline f64 cosd(f64 a) {
+    return f64(cosd_f64(a.v));
+}
+
+// Tangent of degrees, exact argument reduction
+static inline f64 tand(f64 a) {
+    return f64(tand_f64(a.v));
+}
+
+// Sine and cosine of degrees
+static inline f64_sincos sincosd(f64 a) {
+    float4 sc = sincosd_f64(a.v);
+    f64_sincos r;
+    r.sin = f64(sc.xy);
+    r.cos = f64(sc.zw);
+    return r;
+}
+
+// Hyperbolic sine
+static inline f64 sinh(f64 a) {
+    return f64(sinh_f64(a.v));
+}
+
+// Hyperbolic cosine
+static inline f64 cosh(f64 a) {
+    return f64(cosh_f64(a.v));
+}
+
+// Hyperbolic sine and cosine with one exponential
+struct f64_sinhcosh {
+    f64 sinh;
+    f64 cosh;
+};
+
+static inline f64_sinhcosh sinhcosh(f64 a) {
+    float4 sc = sinhcosh_f64(a.v);
+    f64_sinhcosh r;
+    r.sinh = f64(sc.xy);
+    r.cosh = f64(sc.zw);
+    return r;
 }
 
 // Arc Sine
 static inline f64 asin(f64 a) {
-    return f64(asin_iterate(a.v));
+    return f64(asin_f64(a.v));
 }
 
 // Arc Cosine
 static inline f64 acos(f64 a) {
-    return f64(acos_iterate(a.v));
+    return f64(acos_f64(a.v));
 }
 
 // Arc Tangent
 static inline f64 atan(f64 a) {
-    return f64(atan2_iterate(a.v, F2_ONE));
+    return f64(atan_f64(a.v));
 }
 
 // Arc Tangent2
 static inline f64 atan2(f64 a, f64 b) {
-    return f64(atan2_iterate(a.v, b.v));
+    return f64(atan2_f64(a.v, b.v));
+}
+
+// Fused multiply-add a * b + c, one renormalization
+static inline f64 fma(f64 a, f64 b, f64 c) {
+    return f64(fma_f64(a.v, b.v, c.v));
+}
+
+// Fused multiply-subtract a * b - c
+static inline f64 fms(f64 a, f64 b, f64 c) {
+    return f64(fms_f64(a.v, b.v, c.v));
+}
+
+// Fused a * b + c * d, one renormalization
+static inline f64 dot2(f64 a, f64 b, f64 c, f64 d) {
+    return f64(dot2_f64(a.v, b.v, c.v, d.v));
 }
 
 // Overloaded operators
@@ -0,0 +1,166 @@
+//
+//  f64acc.h
+//
+//  Part of Metal64
+//
+//  Implementation of datatype f64acc, an unnormalized accumulator for long
+//  sums and dot products of f64 values
+//
+//  The accumulator keeps three levels in a float4:
+//    .x = sum of the high parts
+//    .y = sum of the low parts and of the rounding errors of .x
+//    .z = rounding errors of .y and low order terms of products
+//
+//  The additions to .x and .y are error free, only .z is rounded. The error of
+//  a sum of n values is about u^2 |sum| + n u^3 sum(|a_i|), u = 2^-24, compared
+//  to n u^2 sum(|a_i|) for a chain of f64 additions. The value is normalized
+//  only when it is read with dbl().
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __F64ACC_H
+#define __F64ACC_H
+
+#include "f64.h"
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Accumulator operations on float4
+// ----------------------------------------------------------------------------
+
+// Add float to accumulator
+static inline float4 acc_add_f(float4 acc, float b) {
+    // .x + b and .y + error, both exact
+    float s = acc.x + b;
+    float v = s - acc.x;
+    float e = (acc.x - (s - v)) + (b - v);
+    float c = acc.y + e;
+    float w = c - acc.y;
+    float f = (acc.y - (c - w)) + (e - w);
+    return float4(s, c, acc.z + f, 0.0f);
+}
+
+// Add f64 to accumulator
+static inline float4 acc_add(float4 acc, float2 a) {
+    // .x + a.x and .y + a.y, both exact
+    float4 t = sump(acc.xy, a);
+
+    // Error of the high sum to the 2nd level, exact
+    float c = t.z + t.y;
+    float w = c - t.z;
+    float f = (t.z - (c - w)) + (t.y - w);
+    return float4(t.x, c, acc.z + (t.w + f), 0.0f);
+}
+
+// Add exact product a * b to accumulator
+static inline float4 acc_add_prod(float4 acc, float a, float b) {
+    return acc_add(acc, prod(a, b));
+}
+
+// Add product of two f64 values to accumulator
+// The cross terms are of 2nd order, their rounding errors are of 3rd order
+static inline float4 acc_add_mul(float4 acc, float2 a, float2 b) {
+    float2 p = prod(a.x, b.x);
+#if METAL64_USE_FMA
+    p.y = fma(a.x, b.y, fma(a.y, b.x, p.y));
+#else
+    p.y += a.x * b.y + a.y * b.x;
+#endif
+    return acc_add(acc, p);
+}
+
+// Add two accumulators (e.g. partial sums of a reduction)
+static inline float4 acc_merge(float4 a, float4 b) {
+    float4 t = sump(a.xy, b.xy);
+
+    float c = t.z + t.y;
+    float w = c - t.z;
+    float f = (t.z - (c - w)) + (t.y - w);
+    return float4(t.x, c, (a.z + b.z) + (t.w + f), 0.0f);
+}
+
+// Normalized value of accumulator
+static inline float2 acc_value(float4 acc) {
+    float2 t = sumq(acc.y, acc.z);
+    float s = acc.x + t.x;
+    float v = s - acc.x;
+    float e = (acc.x - (s - v)) + (t.x - v);
+    return sumq(s, e + t.y);
+}
+
+
+// ----------------------------------------------------------------------------
+//  f64acc
+// ----------------------------------------------------------------------------
+
+// Struct for unnormalized 64 bit sums
+struct f64acc {
+    float4 v;
+
+    f64acc() {
+        v = float4(0.0f);
+    }
+
+    f64acc(float a) {
+        v = float4(a, 0.0f, 0.0f, 0.0f);
+    }
+
+    f64acc(f64 a) {
+        v = float4(a.v, 0.0f, 0.0f);
+    }
+
+    f64acc(float4 a) {
+        v = a;
+    }
+
+    f64acc operator += (f64 a) {
+        v = acc_add(v, a.v);
+        return *this;
+    }
+
+    f64acc operator += (float a) {
+        v = acc_add_f(v, a);
+        return *this;
+    }
+
+    f64acc operator += (f64acc a) {
+        v = acc_merge(v, a.v);
+        return *this;
+    }
+
+    f64acc operator -= (f64 a) {
+        v = acc_add(v, -a.v);
+        return *this;
+    }
+
+    f64acc operator -= (float a) {
+        v = acc_add_f(v, -a);
+        return *this;
+    }
+
+    /// Add product a * b
+    f64acc addmul(f64 a, f64 b) {
+        v = acc_add_mul(v, a.v, b.v);
+        return *this;
+    }
+
+    /// Add exact product a * b of two floats
+    f64acc addmul(float a, float b) {
+        v = acc_add_prod(v, a, b);
+        return *this;
+    }
+};
+
+/// Convert f64acc to f64 (normalize)
+static inline f64 dbl(f64acc a) {
+    return f64(acc_value(a.v));
+}
+
+static inline f64acc operator + (f64acc a, f64acc b) {
+    return f64acc(acc_merge(a.v, b.v));
+}
+
+#endif
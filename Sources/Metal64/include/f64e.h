@@ -0,0 +1,484 @@
+//
+//  f64e.h
+//
+//  Part of Metal64
+//
+//  Implementation of datatypes f64e and c64e, f64 and c64 with an extended
+//  exponent for deep zoom ranges
+//
+//    value = m * 2^e
+//
+//      m = f64 (float2) or c64 (float4) mantissa
+//      e = int exponent
+//
+//  f64 is limited by the float exponent, values below about 1e-38 underflow.
+//  f64e keeps the f64 precision over an exponent range of about +-2^29.
+//
+//  The mantissa is not normalized after every operation. It may drift in the
+//  window 2^-F64E_WINDOW <= |m.x| <= 2^F64E_WINDOW, only a result outside the
+//  window is rescaled (mantissa to [1, 2), exponent adjusted). Every operation
+//  pays the window compare, add and sub also the exponent compare, the select
+//  of the larger operand and one alignment multiply. The complex mantissa of
+//  c64e has a single exponent, its window applies to max(|re.x|, |im.x|), so
+//  the error of both parts is relative to |z| as for c64.
+//
+//  Cost on the host (Host/Benchmarks/bench_f64e.cpp, -O2, x86-64, ns per
+//  operation, exponent differences in random order):
+//
+//    add / sub          11 - 14    f64 add 1.6 - 4.2
+//    mul                 5         f64 mul 1.7 - 4.6
+//    div                24 - 29    f64 div 28 - 31
+//    perturbation step  68 - 82    c64 40 - 46 scalar, 10.5 - 13 vectorized
+//
+//  g++ compiles the operand select to a branch, most of the add time is its
+//  misprediction: with a predictable exponent order add takes 5.6 ns. On the
+//  GPU the select is not a branch, the cost there is not measured.
+//
+//  Zero has the exponent F64E_ZERO. Mantissas must be finite.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __F64E_H
+#define __F64E_H
+
+#include "c64.h"
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Scaling
+// ----------------------------------------------------------------------------
+
+// Mantissa window: rescale if |m.x| > 2^F64E_WINDOW or |m.x| < 2^-F64E_WINDOW
+static constant int F64E_WINDOW = 32;
+static constant float F64E_WINDOW_HI = 4294967296.0f;          // 2^32
+static constant float F64E_WINDOW_LO = 2.3283064365386963e-10f; // 2^-32
+
+// Addition: a smaller operand below 2^-F64E_DROP is dropped (window on both
+// sides and 52 bits)
+static constant int F64E_DROP = 2 * F64E_WINDOW + 52;
+
+// Exponent of zero, far below any other exponent
+static constant int F64E_ZERO = -(1 << 30);
+
+// Exact power of two 2^k, |k| <= 126
+static inline float f64e_pow2(int k) {
+    return as_type<float>(uint(k + 127) << 23);
+}
+
+// Binary exponent of a normal float: a = f * 2^k, 1 <= |f| < 2
+static inline int f64e_ilogb(float a) {
+    return int((as_type<uint>(a) >> 23) & 0xff) - 127;
+}
+
+// m * 2^k, |k| <= 252
+static inline float2 f64e_scale(float2 m, int k) {
+    int k1 = k / 2;
+    return m * f64e_pow2(k1) * f64e_pow2(k - k1);
+}
+
+static inline float4 f64e_scale(float4 m, int k) {
+    int k1 = k / 2;
+    return m * f64e_pow2(k1) * f64e_pow2(k - k1);
+}
+
+// Mantissa m of exponent e - d aligned to exponent e, dropped if d > F64E_DROP.
+// 0 <= d <= F64E_DROP < 126: one exact multiply, by 1 for equal exponents
+static inline float2 f64e_align(float2 m, int d) {
+    return d > F64E_DROP ? F2_ZERO : m * f64e_pow2(-d);
+}
+
+static inline float4 f64e_align(float4 m, int d) {
+    return d > F64E_DROP ? float4(0.0f) : m * f64e_pow2(-d);
+}
+
+
+// ----------------------------------------------------------------------------
+//  f64e
+// ----------------------------------------------------------------------------
+
+// Struct for 64 bit floating points with extended exponent
+struct f64e {
+    float2 m;
+    int e;
+
+    f64e() {
+        m = F2_ZERO;
+        e = F64E_ZERO;
+    }
+
+    f64e(float a) {
+        m = float2(a, 0.0f);
+        e = 0;
+        rescale();
+    }
+
+    f64e(float2 a) {
+        m = a;
+        e = 0;
+        rescale();
+    }
+
+    f64e(f64 a) {
+        m = a.v;
+        e = 0;
+        rescale();
+    }
+
+    /// Value a * 2^k
+    f64e(float2 a, int k) {
+        m = a;
+        e = k;
+        rescale();
+    }
+
+#ifndef __METAL_VERSION__
+    /// Host only: convert a double
+    f64e(double a) {
+        int k;
+        double f = frexp(a, &k);
+        float x = float(f);
+        m = float2(x, float(f - double(x)));
+        e = k;
+        rescale();
+    }
+#endif
+
+    /// Mantissa to [1, 2), if it is outside the window
+    void check() {
+        float ax = abs(m.x);
+        if (ax > F64E_WINDOW_HI || ax < F64E_WINDOW_LO) rescale();
+    }
+
+    /// Mantissa to [1, 2)
+    void rescale() {
+        if (m.x == 0.0f) {
+            m = F2_ZERO;
+            e = F64E_ZERO;
+        } else if (isfinite(m.x)) {
+            int k = f64e_ilogb(m.x);
+            if (k == -127) {
+                // Subnormal
+                m = m * f64e_pow2(64);
+                e -= 64;
+                k = f64e_ilogb(m.x);
+            }
+            m = m * f64e_pow2(-k);
+            e += k;
+        }
+    }
+};
+
+// Result with mantissa m and exponent e
+static inline f64e make_f64e(float2 m, int e) {
+    f64e r;
+    r.m = m;
+    r.e = e;
+    r.check();
+    return r;
+}
+
+// The operand with the smaller exponent is aligned, selects instead of branches
+static inline f64e add_f64e(f64e a, f64e b) {
+    bool s = a.e < b.e;
+    float2 hi = s ? b.m : a.m;
+    float2 lo = s ? a.m : b.m;
+    int e = s ? b.e : a.e;
+    return make_f64e(add_f64(hi, f64e_align(lo, abs(a.e - b.e))), e);
+}
+
+static inline f64e neg_f64e(f64e a) {
+    a.m = -a.m;
+    return a;
+}
+
+static inline f64e sub_f64e(f64e a, f64e b) {
+    return add_f64e(a, neg_f64e(b));
+}
+
+static inline f64e mul_f64e(f64e a, f64e b) {
+    return make_f64e(mul_f64(a.m, b.m), a.e + b.e);
+}
+
+static inline f64e sqr_f64e(f64e a) {
+    return make_f64e(sqr_f64(a.m), 2 * a.e);
+}
+
+static inline f64e div_f64e(f64e a, f64e b) {
+    return make_f64e(div_f64(a.m, b.m), a.e - b.e);
+}
+
+static inline f64e sqrt_f64e(f64e a) {
+    if (a.m.x <= 0.0f) return a.m.x == 0.0f ? a : f64e(flt2(NAN));
+    // Even exponent
+    if (a.e & 1) {
+        a.m = a.m * 2.0f;
+        a.e -= 1;
+    }
+    return make_f64e(sqrt_f64(a.m), a.e / 2);
+}
+
+/// Binary exponent of the value, F64E_ZERO for 0
+static inline int ilogb(f64e a) {
+    return a.m.x == 0.0f ? F64E_ZERO : a.e + f64e_ilogb(a.m.x);
+}
+
+/// Convert f64e to f64, underflow to 0, overflow to infinity
+static inline f64 dbl(f64e a) {
+    int k = ilogb(a);
+    if (k > 127) return f64(flt2(a.m.x < 0.0f ? -INFINITY : INFINITY));
+    if (k < -150) return f64(F2_ZERO);
+    return f64(f64e_scale(a.m, a.e));
+}
+
+/// Convert f64e to float
+static inline float flt(f64e a) {
+    return dbl(a).v.x;
+}
+
+static inline f64e abs(f64e a) {
+    return a.m.x < 0.0f ? neg_f64e(a) : a;
+}
+
+static inline f64e sqr(f64e a) {
+    return sqr_f64e(a);
+}
+
+static inline f64e sqrt(f64e a) {
+    return sqrt_f64e(a);
+}
+
+static inline int sign(f64e a) {
+    return a.m.x < 0.0f ? -1 : (a.m.x > 0.0f ? 1 : 0);
+}
+
+static inline bool isZero(f64e a) {
+    return a.m.x == 0.0f;
+}
+
+// Overloaded operators
+
+static inline f64e operator - (f64e a) {
+    return neg_f64e(a);
+}
+
+static inline f64e operator + (f64e a, f64e b) {
+    return add_f64e(a, b);
+}
+
+static inline f64e operator - (f64e a, f64e b) {
+    return sub_f64e(a, b);
+}
+
+static inline f64e operator * (f64e a, f64e b) {
+    return mul_f64e(a, b);
+}
+
+static inline f64e operator * (f64e a, f64 b) {
+    return make_f64e(mul_f64(a.m, b.v), a.e);
+}
+
+static inline f64e operator * (f64 a, f64e b) {
+    return make_f64e(mul_f64(a.v, b.m), b.e);
+}
+
+static inline f64e operator * (f64e a, float b) {
+    return make_f64e(mul_f64(a.m, flt2(b)), a.e);
+}
+
+static inline f64e operator * (float a, f64e b) {
+    return make_f64e(mul_f64(flt2(a), b.m), b.e);
+}
+
+static inline f64e operator / (f64e a, f64e b) {
+    return div_f64e(a, b);
+}
+
+static inline bool operator < (f64e a, f64e b) {
+    return sign(a - b) < 0;
+}
+
+static inline bool operator > (f64e a, f64e b) {
+    return sign(a - b) > 0;
+}
+
+static inline bool operator <= (f64e a, f64e b) {
+    return sign(a - b) <= 0;
+}
+
+static inline bool operator >= (f64e a, f64e b) {
+    return sign(a - b) >= 0;
+}
+
+
+// ----------------------------------------------------------------------------
+//  c64e
+// ----------------------------------------------------------------------------
+
+// Struct for 64 bit complex numbers with extended exponent
+struct c64e {
+    float4 m;
+    int e;
+
+    c64e() {
+        m = float4(0.0f);
+        e = F64E_ZERO;
+    }
+
+    c64e(c64 a) {
+        m = a.v;
+        e = 0;
+        rescale();
+    }
+
+    c64e(f64e re, f64e im) {
+        e = max(re.e, im.e);
+        m = float4(f64e_align(re.m, e - re.e), f64e_align(im.m, e - im.e));
+        rescale();
+    }
+
+    /// Value a * 2^k
+    c64e(float4 a, int k) {
+        m = a;
+        e = k;
+        rescale();
+    }
+
+    /// Mantissa to max(|re|, |im|) in [1, 2), if it is outside the window
+    void check() {
+        float ax = max(abs(m.x), abs(m.z));
+        if (ax > F64E_WINDOW_HI || ax < F64E_WINDOW_LO) rescale();
+    }
+
+    /// Mantissa to max(|re|, |im|) in [1, 2)
+    void rescale() {
+        float ax = max(abs(m.x), abs(m.z));
+        if (ax == 0.0f) {
+            m = float4(0.0f);
+            e = F64E_ZERO;
+        } else if (isfinite(ax)) {
+            int k = f64e_ilogb(ax);
+            if (k == -127) {
+                m = m * f64e_pow2(64);
+                e -= 64;
+                k = f64e_ilogb(max(abs(m.x), abs(m.z)));
+            }
+            m = m * f64e_pow2(-k);
+            e += k;
+        }
+    }
+
+    /// Return real part of complex number
+    inline f64e real() {
+        return f64e(m.xy, e);
+    }
+
+    /// Return imaginary part of complex number
+    inline f64e imaginary() {
+        return f64e(m.zw, e);
+    }
+};
+
+// Result with mantissa m and exponent e
+static inline c64e make_c64e(float4 m, int e) {
+    c64e r;
+    r.m = m;
+    r.e = e;
+    r.check();
+    return r;
+}
+
+static inline c64e add_c64e(c64e a, c64e b) {
+    bool s = a.e < b.e;
+    float4 hi = s ? b.m : a.m;
+    float4 lo = s ? a.m : b.m;
+    int e = s ? b.e : a.e;
+    return make_c64e(add_c64(hi, f64e_align(lo, abs(a.e - b.e))), e);
+}
+
+static inline c64e sub_c64e(c64e a, c64e b) {
+    b.m = -b.m;
+    return add_c64e(a, b);
+}
+
+static inline c64e mul_c64e(c64e a, c64e b) {
+    return make_c64e(mul_c64(a.m, b.m), a.e + b.e);
+}
+
+static inline c64e sqr_c64e(c64e a) {
+    return make_c64e(sqr_c64(a.m), 2 * a.e);
+}
+
+static inline c64e div_c64e(c64e a, c64e b) {
+    return make_c64e(div_c64(a.m, b.m), a.e - b.e);
+}
+
+/// Convert c64e to c64, underflow to 0
+static inline c64 cplx(c64e a) {
+    return c64(dbl(f64e(a.m.xy, a.e)), dbl(f64e(a.m.zw, a.e)));
+}
+
+/// Square of the absolute value
+static inline f64e norm(c64e a) {
+    return make_f64e(norm_c64(a.m), 2 * a.e);
+}
+
+static inline f64e abs(c64e a) {
+    return make_f64e(abs_c64(a.m), a.e);
+}
+
+static inline c64e sqr(c64e a) {
+    return sqr_c64e(a);
+}
+
+static inline bool isZero(c64e a) {
+    return all(a.m == 0.0f);
+}
+
+// Overloaded operators
+
+static inline c64e operator - (c64e a) {
+    a.m = -a.m;
+    return a;
+}
+
+static inline c64e operator + (c64e a, c64e b) {
+    return add_c64e(a, b);
+}
+
+static inline c64e operator - (c64e a, c64e b) {
+    return sub_c64e(a, b);
+}
+
+static inline c64e operator * (c64e a, c64e b) {
+    return mul_c64e(a, b);
+}
+
+// c64 factors (e.g. a reference orbit) are not rescaled
+static inline c64e operator * (c64e a, c64 b) {
+    return make_c64e(mul_c64(a.m, b.v), a.e);
+}
+
+static inline c64e operator * (c64 a, c64e b) {
+    return make_c64e(mul_c64(a.v, b.m), b.e);
+}
+
+static inline c64e operator * (c64e a, f64e b) {
+    return make_c64e(float4(mul_f64(a.m.xy, b.m), mul_f64(a.m.zw, b.m)), a.e + b.e);
+}
+
+static inline c64e operator * (c64e a, float b) {
+    return make_c64e(a.m * b, a.e);
+}
+
+static inline c64e operator * (float a, c64e b) {
+    return make_c64e(b.m * a, b.e);
+}
+
+static inline c64e operator / (c64e a, c64e b) {
+    return div_c64e(a, b);
+}
+
+#endif
@@ -0,0 +1,329 @@
+//
+//  f64expr.h
+//
+//  Part of Metal64
+//
+//  Expression templates for f64 and c64 (opt-in)
+//
+//  fused(a) marks an operand. Operators with a marked operand do not evaluate,
+//  they build the expression tree at compile time. The tree is evaluated on
+//  assignment to f64 / c64 and lowered to the fused sums of f64fnc.h: a sum
+//  of two terms, at least one of them a product, is renormalized once instead
+//  of once per operator.
+//
+//    f64 r = fused(a) * b + fused(c) * d - e;   // dot2, then one eager sub
+//    c64 z = fused(z) * z + c;                  // fused sums of fma_c64
+//
+//  Lowering (the fsum_* calls of the kernels named, built from the tree):
+//
+//    a * b + c, a * b - c, c - a * b      fsum of fma_f64, fms_f64
+//    a * b + c * d                        fsum of dot2_f64
+//    a * b + c (complex)                  fsum of fma_c64 (other order)
+//    longer sum, last term a product      left part first, then fused with
+//                                         the product (fma_f64)
+//    longer sum, otherwise                left and right part, eager + / -
+//    sum of values only                   eager operators
+//    product of sums                      the sums are evaluated first
+//
+//  Only two terms are fused: a fused sum over more terms carries more
+//  unnormalized words, was slower than the eager operators (27.0 vs 10.6 ns
+//  for a * b + c * d - e) and less accurate (7.8 vs 4.7 ulp).
+//
+//  Only marked subexpressions are fused: in fused(a) * b + c * d the product
+//  c * d is evaluated by the f64 operators before it enters the tree.
+//  The error bound of a fused step is the one of the fused sums (see
+//  f64fnc.h): absolute 2 u^2 sum(|term|), not relative to the result. The
+//  eager operators of f64.h and c64.h are unchanged.
+//
+//  Host, -O2, x86-64, 1e6 random operands in [-2, 2]; ns per expression and
+//  max. error in ulp of the largest term (two runs):
+//
+//    expression            eager ns    fused ns    eager ulp  fused ulp
+//    a * b + c             2.5 - 2.6   1.9         3.28       4.21
+//    a * b + c * d         3.3 - 3.9   2.3 - 2.8   3.38       5.34
+//    a * b + c * d - e     4.7 - 5.6   4.1 - 4.9   4.66       5.34
+//    (a - b) * (c + d)     3.6 - 4.1   3.5 - 4.0   3.05       3.05
+//    z * w + u (re)       31.1 - 42.9 24.9 - 37.1  3.91       6.41
+//    z * w + u * z (im)   57.9 - 70.8 48.7 - 62.0  0.52       0.94
+//
+//  Fusing trades speed for error: up to 1.4x faster, up to 1.6x the error of
+//  the eager operators, which round every intermediate result.
+//
+//  Throughput on the host: Host/Benchmarks/bench_expr.cpp
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __F64EXPR_H
+#define __F64EXPR_H
+
+#include "c64.h"
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Fused sum states
+//
+//  f64: float2 state of fsum_add()
+//  c64: float4, real part .xy, imaginary part .zw
+// ----------------------------------------------------------------------------
+
+template <typename T>
+struct expr_traits;
+
+template <>
+struct expr_traits<f64> {
+    typedef float2 state;
+};
+
+template <>
+struct expr_traits<c64> {
+    typedef float4 state;
+};
+
+// State with the single term sign * a
+static inline float2 expr_state_start(f64 a, float sign) {
+    return a.v * sign;
+}
+
+static inline float4 expr_state_start(c64 a, float sign) {
+    return a.v * sign;
+}
+
+// State with the single term sign * a * b
+static inline float2 expr_state_start_mul(f64 a, f64 b, float sign) {
+    return fsum_mul(a.v * sign, b.v);
+}
+
+static inline float4 expr_state_start_mul(c64 a, c64 b, float sign) {
+    float4 x = a.v * sign;
+    float2 r = fsum_add_mul(fsum_mul(x.xy, b.v.xy), -x.zw, b.v.zw);
+    float2 i = fsum_add_mul(fsum_mul(x.xy, b.v.zw), x.zw, b.v.xy);
+    return float4(r, i);
+}
+
+// Add sign * a
+static inline float2 expr_state_add(float2 s, f64 a, float sign) {
+    return fsum_add(s, a.v * sign);
+}
+
+static inline float4 expr_state_add(float4 s, c64 a, float sign) {
+    float4 x = a.v * sign;
+    return float4(fsum_add(s.xy, x.xy), fsum_add(s.zw, x.zw));
+}
+
+// Add sign * a * b
+static inline float2 expr_state_add_mul(float2 s, f64 a, f64 b, float sign) {
+    return fsum_add_mul(s, a.v * sign, b.v);
+}
+
+static inline float4 expr_state_add_mul(float4 s, c64 a, c64 b, float sign) {
+    float4 x = a.v * sign;
+    float2 r = fsum_add_mul(fsum_add_mul(s.xy, x.xy, b.v.xy), -x.zw, b.v.zw);
+    float2 i = fsum_add_mul(fsum_add_mul(s.zw, x.xy, b.v.zw), x.zw, b.v.xy);
+    return float4(r, i);
+}
+
+// Normalized value
+static inline f64 expr_state_value(float2 s) {
+    return f64(fsum_value(s));
+}
+
+static inline c64 expr_state_value(float4 s) {
+    return c64(fsum_value(s.xy), fsum_value(s.zw));
+}
+
+
+// ----------------------------------------------------------------------------
+//  Expression nodes
+//
+//  products         Node contains a product. Sums without products are
+//                   evaluated by the eager operators: the error of a fused
+//                   sum is absolute, cancellation of values would be inexact.
+//  eval()           Normalized value
+//  start(sign)      Fused sum state of sign * node
+//  add_to(s, sign)  Add sign * node to a state
+// ----------------------------------------------------------------------------
+
+// Value
+template <typename T>
+struct expr_leaf {
+    typedef T value_type;
+    typedef typename expr_traits<T>::state state;
+    enum { products = 0, terms = 1 };
+    T a;
+
+    value_type eval() const { return a; }
+    state start(float sign) const { return expr_state_start(a, sign); }
+    state add_to(state s, float sign) const { return expr_state_add(s, a, sign); }
+};
+
+// a + b
+template <typename A, typename B>
+struct expr_sum {
+    typedef typename A::value_type value_type;
+    typedef typename expr_traits<value_type>::state state;
+    enum { products = A::products || B::products, terms = A::terms + B::terms };
+    A a;
+    B b;
+
+    // Two terms are one fused sum, longer sums are split (see Lowering)
+    value_type eval() const {
+        if (!products) return a.eval() + b.eval();
+        if (terms <= 2) return expr_state_value(start(1.0f));
+        if (B::products && B::terms == 1) return expr_state_value(b.add_to(expr_state_start(a.eval(), 1.0f), 1.0f));
+        return a.eval() + b.eval();
+    }
+    state start(float sign) const { return b.add_to(a.start(sign), sign); }
+    state add_to(state s, float sign) const { return b.add_to(a.add_to(s, sign), sign); }
+};
+
+// a - b
+template <typename A, typename B>
+struct expr_diff {
+    typedef typename A::value_type value_type;
+    typedef typename expr_traits<value_type>::state state;
+    enum { products = A::products || B::products, terms = A::terms + B::terms };
+    A a;
+    B b;
+
+    // Two terms are one fused sum, longer sums are split (see Lowering)
+    value_type eval() const {
+        if (!products) return a.eval() - b.eval();
+        if (terms <= 2) return expr_state_value(start(1.0f));
+        if (B::products && B::terms == 1) return expr_state_value(b.add_to(expr_state_start(a.eval(), 1.0f), -1.0f));
+        return a.eval() - b.eval();
+    }
+    state start(float sign) const { return b.add_to(a.start(sign), -sign); }
+    state add_to(state s, float sign) const { return b.add_to(a.add_to(s, sign), -sign); }
+};
+
+// a * b, the factors are evaluated first, a single product is the eager one
+template <typename A, typename B>
+struct expr_prod {
+    typedef typename A::value_type value_type;
+    typedef typename expr_traits<value_type>::state state;
+    enum { products = 1, terms = 1 };
+    A a;
+    B b;
+
+    value_type eval() const { return a.eval() * b.eval(); }
+    state start(float sign) const { return expr_state_start_mul(a.eval(), b.eval(), sign); }
+    state add_to(state s, float sign) const { return expr_state_add_mul(s, a.eval(), b.eval(), sign); }
+};
+
+// -a
+template <typename A>
+struct expr_neg {
+    typedef typename A::value_type value_type;
+    typedef typename expr_traits<value_type>::state state;
+    enum { products = A::products, terms = A::terms };
+    A a;
+
+    value_type eval() const { return expr_state_value(products ? start(1.0f) : expr_state_start(a.eval(), -1.0f)); }
+    state start(float sign) const { return a.start(-sign); }
+    state add_to(state s, float sign) const { return a.add_to(s, -sign); }
+};
+
+
+// ----------------------------------------------------------------------------
+//  Marked expressions
+// ----------------------------------------------------------------------------
+
+template <typename E>
+struct fused_expr {
+    typedef typename E::value_type value_type;
+    E e;
+
+    /// Evaluate on assignment
+    operator value_type() const {
+        return e.eval();
+    }
+};
+
+template <typename E>
+static inline fused_expr<E> make_fused(E e) {
+    fused_expr<E> r;
+    r.e = e;
+    return r;
+}
+
+template <typename T>
+static inline expr_leaf<T> make_leaf(T a) {
+    expr_leaf<T> r;
+    r.a = a;
+    return r;
+}
+
+template <template <typename, typename> class N, typename A, typename B>
+static inline fused_expr<N<A, B> > make_node(A a, B b) {
+    N<A, B> r;
+    r.a = a;
+    r.b = b;
+    return make_fused(r);
+}
+
+/// Mark an operand for fused evaluation
+static inline fused_expr<expr_leaf<f64> > fused(f64 a) {
+    return make_fused(make_leaf(a));
+}
+
+static inline fused_expr<expr_leaf<c64> > fused(c64 a) {
+    return make_fused(make_leaf(a));
+}
+
+/// Evaluate explicitly
+template <typename E>
+static inline typename E::value_type eval(fused_expr<E> a) {
+    return a.e.eval();
+}
+
+
+// ----------------------------------------------------------------------------
+//  Operators
+//
+//  expression op expression, expression op value, value op expression,
+//  floats are converted to values
+// ----------------------------------------------------------------------------
+
+#define METAL64_EXPR_OPERATOR(OP, NODE)                                                             \
+template <typename A, typename B>                                                                   \
+static inline fused_expr<NODE<A, B> > operator OP (fused_expr<A> a, fused_expr<B> b) {              \
+    return make_node<NODE>(a.e, b.e);                                                               \
+}                                                                                                   \
+template <typename A>                                                                               \
+static inline fused_expr<NODE<A, expr_leaf<typename A::value_type> > >                             \
+operator OP (fused_expr<A> a, typename A::value_type b) {                                           \
+    return make_node<NODE>(a.e, make_leaf(b));                                                      \
+}                                                                                                   \
+template <typename A>                                                                               \
+static inline fused_expr<NODE<expr_leaf<typename A::value_type>, A> >                               \
+operator OP (typename A::value_type a, fused_expr<A> b) {                                           \
+    return make_node<NODE>(make_leaf(a), b.e);                                                      \
+}                                                                                                   \
+template <typename A>                                                                               \
+static inline fused_expr<NODE<A, expr_leaf<typename A::value_type> > >                             \
+operator OP (fused_expr<A> a, float b) {                                                            \
+    return make_node<NODE>(a.e, make_leaf(typename A::value_type(b)));                              \
+}                                                                                                   \
+template <typename A>                                                                               \
+static inline fused_expr<NODE<expr_leaf<typename A::value_type>, A> >                               \
+operator OP (float a, fused_expr<A> b) {                                                            \
+    return make_node<NODE>(make_leaf(typename A::value_type(a)), b.e);                              \
+}
+
+METAL64_EXPR_OPERATOR(+, expr_sum)
+METAL64_EXPR_OPERATOR(-, expr_diff)
+METAL64_EXPR_OPERATOR(*, expr_prod)
+
+#undef METAL64_EXPR_OPERATOR
+
+template <typename A>
+static inline fused_expr<expr_neg<A> > operator - (fused_expr<A> a) {
+    expr_neg<A> r;
+    r.a = a.e;
+    return make_fused(r);
+}
+
+#endif
@@ -32,6 +32,52 @@
 using namespace metal;
 
 
+// ----------------------------------------------------------------------------
+//  Build options
+// ----------------------------------------------------------------------------
+
+// Exact products of two floats:
+//
+//   1 = p = a * b, e = fma(a, b, -p)  (requires a correctly rounded fma())
+//   0 = Dekker splitting, 17 flops
+//
+// Apple GPUs have a correctly rounded fma(). On the host FMA is used if the
+// target supports it in hardware (e.g. -mfma or -march=native).
+#ifndef METAL64_USE_FMA
+#if defined(__METAL_VERSION__) || defined(__FMA__)
+#define METAL64_USE_FMA 1
+#else
+#define METAL64_USE_FMA 0
+#endif
+#endif
+
+// Accuracy tier of f64 addition, subtraction and division (add_f64, sub_f64,
+// div_f64 and everything built on them, including the f64 and c64 operators):
+//
+//   1 = accurate (IEEE style) kernels
+//   0 = sloppy kernels, fewer flops, for iteration kernels which tolerate
+//       a larger error
+//
+// Both tiers are always available as add_f64_accurate / add_f64_sloppy and
+// div_f64_accurate / div_f64_sloppy.
+//
+// Relative error bounds, u = 2^-24 (unit roundoff of float), and measured
+// maxima in ulp of a 48 bit mantissa (Host/Benchmarks/bench_tiers.cpp):
+//
+//              accurate               sloppy
+//   add, sub   3 u^2, 1.25 ulp        3 u^2, 1.44 ulp if a.x and b.x have the same sign,
+//                                     otherwise absolute error u^2 (|a| + |b|),
+//                                     unbounded relative error on cancellation
+//   mul        4 u^2, 2.4 ulp         same as accurate
+//   div        3 quotient digits      2 quotient digits
+//              1.2 ulp, 59 flops      4.9 ulp, 22 flops
+//
+// Argument reductions (f64poly.h) always use the accurate addition.
+#ifndef METAL64_F64_ACCURATE
+#define METAL64_F64_ACCURATE 1
+#endif
+
+
 // ----------------------------------------------------------------------------
 //  Constants
 // ----------------------------------------------------------------------------
@@ -70,14 +116,13 @@ static constant float2 F2_EXPMIN = float2(-87.33655f, 2.3201194e-07f);  // -126
 //  Declare functions
 // ----------------------------------------------------------------------------
 
-static float2 log_remez(float2);
-static float4 sincos_iterate(float2);
-static float2 tan_iterate(float2);
-static float2 asin_iterate(float2);
-static float2 acos_iterate(float2);
-static float2 atan2_iterate(float2, float2);
-static float2 exp_iterate(float2);
-static float2 log_iterate(float2);
+static float4 sincos_poly(float2);
+static float4 sincospi_poly(float2);
+static float4 sincosd_poly(float2);
+static float2 exp_poly(float2);
+static float4 sinhcosh_poly(float2);
+static float2 log_poly(float2);
+static float2 atan2_poly(float2, float2);
 
 static inline float2 flt2(float);
 
@@ -123,17 +168,34 @@ static inline float2 full_renorm(float2 a) {
     return float2(ss, ee);
 }
 
-// Add hi and lo
-static inline float2 sumq(float a, float b) {
+// ----------------------------------------------------------------------------
+//  Error-free transformations
+//
+//  Shared by f64, f128 (f128fnc.h) and expansion<N> (expansion.h)
+// ----------------------------------------------------------------------------
+
+// Calculate s = a + b and error e
+static inline float2 two_sum(float a, float b) {
+    float s = a + b;
+    float v = s - a;
+    float e = (a - (s - v)) + (b - v);
+    return float2(s, e);
+}
+
+// Quick version of two_sum if |a| >= |b|
+static inline float2 quick_two_sum(float a, float b) {
     float s = a + b;
     float e = b - (s - a);
     return float2(s, e);
 }
 
+// Add hi and lo
+static inline float2 sumq(float a, float b) {
+    return quick_two_sum(a, b);
+}
+
 static inline float2 sumq(float2 a) {
-    float s = a.x + a.y;
-    float e = a.y - (s - a.x);
-    return float2(s, e);
+    return quick_two_sum(a.x, a.y);
 }
 
 static inline float4 sump(float2 a_ri, float2 b_ri) {
@@ -143,6 +205,14 @@ static inline float4 sump(float2 a_ri, float2 b_ri) {
     return float4(s.x, e.x, s.y, e.y);
 }
 
+// Split float into 2 parts of 12 bits
+static inline float2 split(float a) {
+    float t = a * 4097.0f;
+    float a_hi = t - (t - a);
+    float a_lo = a - a_hi;
+    return float2(a_hi, a_lo);
+}
+
 // Split two 32 bit floats into four 16 bit floats
 static inline float4 split4(float2 c) {
     float2 t = c * 4097.0;
@@ -151,13 +221,22 @@ static inline float4 split4(float2 c) {
     return float4(c_hi.x, c_lo.x, c_hi.y, c_lo.y);
 }
 
-static inline float2 prod(float a, float b) {
+// Exact product of two floats
+static inline float2 two_prod(float a, float b) {
     float p = a * b;
+#if METAL64_USE_FMA
+    float e = fma(a, b, -p);
+#else
     float4 s = split4(float2(a, b));
     float e = ((s.x * s.z - p) + s.x * s.w + s.y * s.z) + s.y * s.w;
+#endif
     return float2(p, e);
 }
 
+static inline float2 prod(float a, float b) {
+    return two_prod(a, b);
+}
+
 // ----------------------------------------------------------------------------
 // Compare two 64 bit floating point values
 // ----------------------------------------------------------------------------
@@ -230,8 +309,8 @@ static inline float2 neg_f64(float2 a) {
     return float2(-a.x, -a.y);
 }
 
-// Add 2 64 bit floating point values
-static inline float2 add_f64(float2 a, float2 b) {
+// Add 2 64 bit floating point values, accurate
+static inline float2 add_f64_accurate(float2 a, float2 b) {
     float4 st = sump(a, b);
     st.y += st.z;
     st.xy = sumq(st.xy);
@@ -239,18 +318,35 @@ static inline float2 add_f64(float2 a, float2 b) {
     return sumq(st.xy);
 }
 
+// Add 2 64 bit floating point values, sloppy: only the high parts are added exactly
+static inline float2 add_f64_sloppy(float2 a, float2 b) {
+    float s = a.x + b.x;
+    float v = s - a.x;
+    float e = (a.x - (s - v)) + (b.x - v);
+    return sumq(s, e + (a.y + b.y));
+}
+
+// Add 2 64 bit floating point values
+static inline float2 add_f64(float2 a, float2 b) {
+#if METAL64_F64_ACCURATE
+    return add_f64_accurate(a, b);
+#else
+    return add_f64_sloppy(a, b);
+#endif
+}
+
 // Add float to 64 bit floating point
+// Exact sum of a.x and b (|b| may be greater than |a.x|)
 static inline float2 add_ds(float2 a, float b) {
-    float2 s = sumq(a.x, b);
-    s.y += a.y;
-    return sumq(s);
+    float s = a.x + b;
+    float v = s - a.x;
+    float e = (a.x - (s - v)) + (b - v);
+    return sumq(s, e + a.y);
 }
 
 // Add float to 64 bit floating point
 static inline float2 add_sd(float a, float2 b) {
-    float2 s = sumq(b.x, a);
-    s.y += b.y;
-    return sumq(s);
+    return add_ds(b, a);
 }
 
 // Subtract 2 64 bit floating point values
@@ -265,27 +361,39 @@ static inline float2 sub_ds(float2 a, float b) {
 
 // Subtract f64 from float
 static inline float2 sub_sd(float a, float2 b) {
-    return -add_sd(a, b);
+    return add_sd(a, -b);
 }
 
 // Multiplication: f64 * f64
 static inline float2 mul_f64(float2 a, float2 b) {
     float2 p = prod(a.x, b.x);
+#if METAL64_USE_FMA
+    p.y = fma(a.x, b.y, fma(a.y, b.x, p.y));
+#else
     p.y += a.x * b.y + a.y * b.x;
+#endif
     return sumq(p);
 }
 
 // Multiplication: f64 * f32
 static inline float2 mul_ds(float2 a, float b) {
     float2 p = prod(a.x, b);
+#if METAL64_USE_FMA
+    p.y = fma(a.y, b, p.y);
+#else
     p.y += a.y * b;
+#endif
     return sumq(p);
 }
 
 // Square of f64
 static inline float2 sqr_f64(float2 a) {
     float2 p = prod(a.x, a.x);
+#if METAL64_USE_FMA
+    p.y = fma(2.0f * a.x, a.y, p.y);
+#else
     p.y += 2.0f * a.x * a.y;
+#endif
     return sumq(p);
 }
 
@@ -294,14 +402,32 @@ static inline float2 sqr_f64(float a) {
     return sumq(prod(a, a));
 }
 
+// Division: f64 / f64, accurate: 3 quotient digits
+static inline float2 div_f64_accurate(float2 a, float2 b) {
+    float q1 = a.x / b.x;
+    float2 r = add_f64_accurate(a, -mul_ds(b, q1));
+    float q2 = r.x / b.x;
+    // Only the high part of the 2nd remainder is needed
+    r = add_f64_sloppy(r, -mul_ds(b, q2));
+    float q3 = r.x / b.x;
+    return add_ds(sumq(q1, q2), q3);
+}
+
+// Division: f64 / f64, sloppy: 2 quotient digits
+static inline float2 div_f64_sloppy(float2 a, float2 b) {
+    float q1 = a.x / b.x;
+    float2 r = add_f64_sloppy(a, -mul_ds(b, q1));
+    float q2 = r.x / b.x;
+    return sumq(q1, q2);
+}
+
 // Division: f64 / f64
 static inline float2 div_f64(float2 a, float2 b) {
-    float xn = 1.0f / b.x;
-    float yn = a.x * xn;
-    float2 byn = mul_ds(b, yn);
-    float diff = sub_f64(a, byn).x;
-    float2 p = prod(xn, diff);
-    return add_f64(flt2(yn), p);
+#if METAL64_F64_ACCURATE
+    return div_f64_accurate(a, b);
+#else
+    return div_f64_sloppy(a, b);
+#endif
 }
 
 // Rounding
@@ -315,6 +441,68 @@ static inline float2 round_f64(float2 a) {
 }
 
 
+// ----------------------------------------------------------------------------
+//  Fused sums of products
+//
+//  Sums of f64 values and products of two f64 values with one renormalization
+//  at the end: the high parts are added exactly (two-sum), the low parts, the
+//  rounding errors of the high parts and the low order terms of the products
+//  are added in float. The state is an unnormalized float2.
+//
+//  Absolute error about 2 u^2 sum(|term|), u = 2^-24. This is the size of the
+//  rounding error of the f64 products themselves, so a * b + c * d is as
+//  accurate as with mul_f64 and add_f64, with one renormalization instead of
+//  four. Sums of exact values with cancellation should use add_f64.
+// ----------------------------------------------------------------------------
+
+// Unnormalized exact product plus low order terms
+static inline float2 fsum_mul(float2 a, float2 b) {
+    float2 p = prod(a.x, b.x);
+#if METAL64_USE_FMA
+    p.y = fma(a.x, b.y, fma(a.y, b.x, p.y));
+#else
+    p.y += a.x * b.y + a.y * b.x;
+#endif
+    return p;
+}
+
+// Add f64 to the state
+static inline float2 fsum_add(float2 s, float2 a) {
+    float t = s.x + a.x;
+    float v = t - s.x;
+    float e = (s.x - (t - v)) + (a.x - v);
+    return float2(t, s.y + (e + a.y));
+}
+
+// Add product a * b to the state
+static inline float2 fsum_add_mul(float2 s, float2 a, float2 b) {
+    return fsum_add(s, fsum_mul(a, b));
+}
+
+// Normalized value of the state, the high part may have cancelled
+static inline float2 fsum_value(float2 s) {
+    float t = s.x + s.y;
+    float v = t - s.x;
+    float e = (s.x - (t - v)) + (s.y - v);
+    return float2(t, e);
+}
+
+// Fused multiply-add a * b + c
+static inline float2 fma_f64(float2 a, float2 b, float2 c) {
+    return fsum_value(fsum_add(fsum_mul(a, b), c));
+}
+
+// Fused multiply-subtract a * b - c
+static inline float2 fms_f64(float2 a, float2 b, float2 c) {
+    return fsum_value(fsum_add(fsum_mul(a, b), -c));
+}
+
+// Fused dot product of length 2: a * b + c * d
+static inline float2 dot2_f64(float2 a, float2 b, float2 c, float2 d) {
+    return fsum_value(fsum_add_mul(fsum_mul(a, b), c, d));
+}
+
+
 // ----------------------------------------------------------------------------
 //  Square root, exponential, logarithm and trigonomical functions
 // ----------------------------------------------------------------------------
@@ -328,92 +516,14 @@ static inline float2 sqrt_f64(float2 a) {
     return add_f64(flt2(yn), p);
 }
 
-static constant float2 F2_LN2_HI = float2(0.693147182f, 0.0f);
-static constant float2 F2_LN2_LO = float2(-1.90465429995776020e-9f, 0.0f);
-
-static float2 exp_core(float2 r) {
-    float2 res = float2(7.6471636e-13f, 1.22007105e-20f);                   // 1/15!
-    res = add_f64(float2(1.1470745e-11f, 2.3722077e-19f), mul_f64(r, res)); // 1/14!
-    res = add_f64(float2(1.6059044e-10, -5.3525265e-18), mul_f64(r, res));  // 1/13!
-    res = add_f64(float2(2.0876756e-09, 1.108284e-16),  mul_f64(r, res));   // 1/12!
-    res = add_f64(float2(2.5052108e-08, 4.417623e-16),  mul_f64(r, res));
-    res = add_f64(float2(2.755732e-07, -7.575112e-15),  mul_f64(r, res));
-    res = add_f64(float2(2.7557319e-06, 3.7935712e-14),  mul_f64(r, res));
-    res = add_f64(float2(2.4801588e-05, -3.406996e-13),  mul_f64(r, res));
-    res = add_f64(float2(0.0001984127, -2.7255969e-12),  mul_f64(r, res));
-    res = add_f64(float2(0.0013888889, -3.3631094e-11),  mul_f64(r, res));
-    res = add_f64(float2(0.008333334, -4.346172e-10),  mul_f64(r, res));
-    res = add_f64(float2(0.041666668, -1.2417635e-09),  mul_f64(r, res));
-    res = add_f64(float2(0.16666667, -4.967054e-09),  mul_f64(r, res));
-    res = add_f64(float2(0.5, 0.0),  mul_f64(r, res));
-    res = add_f64(F2_ONE, mul_f64(r, res));  // 1 + r*(...)
-    res = add_f64(F2_ONE, mul_f64(r, res));  // exp(r) = 1 + r*(1 + ...)
-    
-    return res;
-}
-
-static float2 exp_f64(float2 x) {
-    if (gt(x, F2_EXPMAX)) return flt2(INFINITY);
-    if (lt(x, F2_EXPMIN)) return F2_ZERO;
-
-    float2 fm = round_f64(div_f64(x, F2_LOG2));
-    int m = (int)fm.x;
-
-    // Hochpräzise Argumentreduktion in zwei Schritten
-    float2 r = sub_f64(x, mul_f64(fm, F2_LN2_HI));
-    r = sub_f64(r,         mul_f64(fm, F2_LN2_LO));
-
-    float2 er = exp_core(r);
-    
-    float scale = ldexp(1.0f, m);
-    er.x *= scale;
-    er.y *= scale;
-    
-    return er;
+// Exponential function
+static inline float2 exp_f64(float2 x) {
+    return exp_poly(x);
 }
 
 // Natural logarithm
-static float2 log_f64(float2 a) {
-    if (eq(a, F2_ONE)) return F2_ZERO;
-    if (le(a, F2_ZERO)) return flt2(NAN);
-
-    // Extract exponent from float32
-    uint bits = as_type<uint>(a.x);
-    int e = (int)((bits >> 23) & 0xFF) - 127;
-
-    // m = a * 2^-e, exact because 2^-e is a power of 2
-    float2 m = mul_f64(a, flt2(ldexp(1.0f, -e)));
-
-    // Ensure that m in [1, 2)
-    if (lt(m, F2_ONE)) { m = mul_f64(m, flt2(2.0f)); e--; }
-    if (ge(m, flt2(2.0f))) { m = mul_f64(m, flt2(0.5f)); e++; }
-
-    float2 ln_m = log_remez(m);
-    return add_f64(ln_m, mul_f64(flt2((float)e), F2_LOG2));
-}
-
-static float2 log_remez(float2 m) {
-    float2 t  = div_f64(sub_ds(m, 1.0f), add_ds(m, 1.0f));
-    float2 t2 = mul_f64(t, t);
-
-    // 1/23 + t²*(1/21 + t²*(1/19 + t²*1)) ...
-    // Do not use a loop or lookup table! This would drop the performance.
-    // Start with 1/23: error <= 1e-14
-    float2 r = F2_1_23;
-    r = add_f64(F2_1_21, mul_f64(t2, r));
-    r = add_f64(F2_1_19, mul_f64(t2, r));
-    r = add_f64(F2_1_17, mul_f64(t2, r));
-    r = add_f64(F2_1_15, mul_f64(t2, r));
-    r = add_f64(F2_1_13, mul_f64(t2, r));
-    r = add_f64(F2_1_11, mul_f64(t2, r));
-    r = add_f64(F2_1_9, mul_f64(t2, r));
-    r = add_f64(F2_1_7, mul_f64(t2, r));
-    r = add_f64(F2_1_5, mul_f64(t2, r));
-    r = add_f64(F2_1_3, mul_f64(t2, r));
-    r = add_f64(F2_ONE, mul_f64(t2, r));
-    r = mul_f64(mul_ds(t, 2.0f), r);         // 2t  * (...)
-
-    return r;
+static inline float2 log_f64(float2 a) {
+    return log_poly(a);
 }
 
 // Power f64, f64
@@ -466,43 +576,118 @@ static inline float2 fmod_f64(float2 a, float2 b) {
 
 // Sine
 static inline float2 sin_f64(float2 a) {
-    return sincos_iterate(a).xy;
+    return sincos_poly(a).xy;
 }
 
 // Cosine
 static inline float2 cos_f64(float2 a) {
-    return sincos_iterate(a).zw;
+    return sincos_poly(a).zw;
+}
+
+// Sine and cosine with one argument reduction: returns float4(sin(a), cos(a))
+static inline float4 sincos_f64(float2 a) {
+    return sincos_poly(a);
 }
 
 // Tangent
 static inline float2 tan_f64(float2 a) {
-    return tan_iterate(a);
+    float4 sc = sincos_poly(a);
+    return div_f64(sc.xy, sc.zw);
+}
+
+// Sine and cosine of PI * a: returns float4(sin(PI * a), cos(PI * a))
+static inline float4 sincospi_f64(float2 a) {
+    return sincospi_poly(a);
+}
+
+// sin(PI * a)
+static inline float2 sinpi_f64(float2 a) {
+    return sincospi_poly(a).xy;
+}
+
+// cos(PI * a)
+static inline float2 cospi_f64(float2 a) {
+    return sincospi_poly(a).zw;
+}
+
+// tan(PI * a)
+static inline float2 tanpi_f64(float2 a) {
+    float4 sc = sincospi_poly(a);
+    if (sc.z == 0.0f) return flt2(sc.x / sc.z);
+    return div_f64(sc.xy, sc.zw);
+}
+
+// Sine and cosine of degrees: returns float4(sin(a deg), cos(a deg))
+static inline float4 sincosd_f64(float2 a) {
+    return sincosd_poly(a);
+}
+
+// Sine of degrees
+static inline float2 sind_f64(float2 a) {
+    return sincosd_poly(a).xy;
+}
+
+// Cosine of degrees
+static inline float2 cosd_f64(float2 a) {
+    return sincosd_poly(a).zw;
+}
+
+// Tangent of degrees
+static inline float2 tand_f64(float2 a) {
+    float4 sc = sincosd_poly(a);
+    if (sc.z == 0.0f) return flt2(sc.x / sc.z);
+    return div_f64(sc.xy, sc.zw);
+}
+
+// Hyperbolic sine and cosine with one exponential: returns float4(sinh(a), cosh(a))
+static inline float4 sinhcosh_f64(float2 a) {
+    return sinhcosh_poly(a);
+}
+
+// Hyperbolic sine
+static inline float2 sinh_f64(float2 a) {
+    return sinhcosh_poly(a).xy;
+}
+
+// Hyperbolic cosine
+static inline float2 cosh_f64(float2 a) {
+    return sinhcosh_poly(a).zw;
 }
 
 // Inverse tangent
 static inline float2 atan_f64(float2 a) {
-    return atan2_iterate(a, F2_ONE);
+    return atan2_poly(a, F2_ONE);
 }
 
 // Inverse tangent2
 static inline float2 atan2_f64(float2 y, float2 x) {
-    return atan2_iterate(y, x);
+    return atan2_poly(y, x);
+}
+
+// sqrt(1 - a^2), 1 - a and 1 + a are exact near |a| = 1
+// The relative error of the root passes directly into asin(a) for small a,
+// so sqrt_f64() is refined by one Newton correction r = r + (w - r^2) / 2r
+static inline float2 sqrt_1_sqr_f64(float2 a) {
+    float2 w = mul_f64(sub_sd(1.0f, a), add_sd(1.0f, a));
+    if (w.x == 0.0f) return F2_ZERO;
+    
+    float2 r = sqrt_f64(w);
+    float d = sub_f64(w, sqr_f64(r)).x;
+    return add_ds(r, d / (2.0f * r.x));
 }
 
-// Inverse sine
+// Inverse sine: asin(a) = atan2(a, sqrt(1 - a^2))
 static inline float2 asin_f64(float2 a) {
-    // asin_iterate() is faster while atan2_iterate is more accurate
-    return asin_iterate(a);
-    // return atan2_iterate(a, sqrt_f64(sub_f64(F2_ONE, sqr_f64(a))));
+    if (lt(a, flt2(-1)) || gt(a, F2_ONE)) return NAN;
+    
+    return atan2_poly(a, sqrt_1_sqr_f64(a));
 }
 
-// Inverse cosine
+// Inverse cosine: acos(a) = atan2(sqrt(1 - a^2), a)
 static inline float2 acos_f64(float2 a) {
-    if(lt(a, flt2(-1)) || gt(a, F2_ONE)) return NAN;
+    if (lt(a, flt2(-1)) || gt(a, F2_ONE)) return NAN;
     
-    // acos_iterate() is faster while atan2_iterate is more accurate
-    return acos_iterate(a);
-    // return atan2_iterate(sqrt_f64(sub_f64(F2_ONE, sqr_f64(a))), a);
+    return atan2_poly(sqrt_1_sqr_f64(a), a);
 }
 
 // ----------------------------------------------------------------------------
@@ -536,6 +721,13 @@ static inline float4 sqr_c64(float4 a) {
     return float4(sub_f64(r1, r2), add_f64(i1, i1));
 }
 
+// Fused complex multiply-add a * b + c, each component is renormalized once
+static inline float4 fma_c64(float4 a, float4 b, float4 c) {
+    float2 r = fsum_add_mul(fsum_add(fsum_mul(a.xy, b.xy), c.xy), -a.zw, b.zw);
+    float2 i = fsum_add_mul(fsum_add(fsum_mul(a.xy, b.zw), c.zw), a.zw, b.xy);
+    return float4(fsum_value(r), fsum_value(i));
+}
+
 // Divide 2 64 bit complex values
 static inline float4 div_c64(float4 a, float4 b) {
     float2 d = add_f64(mul_f64(b.xy, b.xy), mul_f64(b.zw, b.zw));
@@ -552,10 +744,74 @@ static inline float4 sqrt_c64(float4 a) {
     return float4(r, i);
 }
 
-// 64 bit complex exponential function
+// cis(a) = cos(a) + i sin(a) = exp(i a)
+static inline float4 cis_c64(float2 a) {
+    float4 sc = sincos_poly(a);
+    return float4(sc.zw, sc.xy);
+}
+
+// 64 bit complex exponential function: exp(a) = exp(re) * cis(im)
 static inline float4 exp_c64(float4 a) {
     float2 e = exp_f64(a.xy);
-    return float4(mul_f64(e, cos_f64(a.zw)), mul_f64(e, sin_f64(a.zw)));
+    float4 sc = sincos_poly(a.zw);
+    return float4(mul_f64(e, sc.zw), mul_f64(e, sc.xy));
+}
+
+// 64 bit complex sine: sin(x + iy) = sin(x) cosh(y) + i cos(x) sinh(y)
+static inline float4 sin_c64(float4 a) {
+    float4 sc = sincos_poly(a.xy);
+    float4 sch = sinhcosh_poly(a.zw);
+    return float4(mul_f64(sc.xy, sch.zw), mul_f64(sc.zw, sch.xy));
+}
+
+// 64 bit complex cosine: cos(x + iy) = cos(x) cosh(y) - i sin(x) sinh(y)
+static inline float4 cos_c64(float4 a) {
+    float4 sc = sincos_poly(a.xy);
+    float4 sch = sinhcosh_poly(a.zw);
+    return float4(mul_f64(sc.zw, sch.zw), -mul_f64(sc.xy, sch.xy));
+}
+
+// Result of a fused Mandelbrot step
+struct mandel_c64_t {
+    float4 z;       // z^2 + c
+    float2 norm;    // norm of the input z
+};
+
+// Fused Mandelbrot step z^2 + c, returns norm(z) for the escape test as well
+// The three squares share the operand splits, the high parts are summed
+// exactly and each component is renormalized once.
+// Absolute error below 4 u^2 (|z|^2 + |c|), u = 2^-24
+static inline mandel_c64_t mandel_norm_c64(float4 z, float4 c) {
+    // x^2, y^2, x * y: exact products of the high parts plus low order terms
+    float xx = z.x * z.x;
+    float yy = z.z * z.z;
+    float xy = z.x * z.z;
+#if METAL64_USE_FMA
+    float xx_e = fma(2.0f * z.x, z.y, fma(z.x, z.x, -xx));
+    float yy_e = fma(2.0f * z.z, z.w, fma(z.z, z.z, -yy));
+    float xy_e = fma(z.x, z.w, fma(z.y, z.z, fma(z.x, z.z, -xy)));
+#else
+    float4 s = split4(float2(z.x, z.z));
+    float xx_e = ((s.x * s.x - xx) + 2.0f * s.x * s.y) + s.y * s.y + 2.0f * z.x * z.y;
+    float yy_e = ((s.z * s.z - yy) + 2.0f * s.z * s.w) + s.w * s.w + 2.0f * z.z * z.w;
+    float xy_e = ((s.x * s.z - xy) + s.x * s.w + s.y * s.z) + s.y * s.w + z.x * z.w + z.y * z.z;
+#endif
+
+    // x^2 - y^2 and x^2 + y^2
+    float4 t = sump(float2(xx, xx), float2(-yy, yy));
+
+    // x^2 - y^2 + c.re and 2 x y + c.im
+    float4 u = sump(float2(t.x, 2.0f * xy), float2(c.x, c.z));
+
+    mandel_c64_t r;
+    r.z = float4(sumq(u.x, u.y + t.y + (xx_e - yy_e) + c.y), sumq(u.z, u.w + 2.0f * xy_e + c.w));
+    r.norm = sumq(t.z, t.w + (xx_e + yy_e));
+    return r;
+}
+
+// Fused Mandelbrot step z^2 + c
+static inline float4 mandel_c64(float4 z, float4 c) {
+    return mandel_norm_c64(z, c).z;
 }
 
 // Compare 64 bit complex values
@@ -0,0 +1,244 @@
+//
+//  f64gemm.h
+//
+//  Part of Metal64
+//
+//  Matrix multiplication C = alpha A B + beta C of f64 and c64 matrices
+//  (row major, leading dimensions lda, ldb, ldc)
+//
+//  Blocking:
+//
+//    1. A threadgroup computes a BM x BN block of C. For every step of BK
+//       columns of A / rows of B, the threads load the BM x BK block of A and
+//       the BK x BN block of B into threadgroup memory (gemm_load).
+//    2. Every thread owns a TM x TN tile of the block in registers and
+//       accumulates it from threadgroup memory (gemm_f64_tile::accumulate).
+//       Per step of k, TM + TN elements are read for TM * TN products.
+//
+//  The inner products use deferred normalization: for one step of BK, the
+//  products of an element are added to an unnormalized float2 state (fused
+//  sums of f64fnc.h, one two-sum per product), the state is added to the
+//  accumulator of f64acc.h once per step and the accumulator is normalized
+//  once when the tile is stored. The error of an element is about
+//  2 u^2 sum(|a_ik b_kj|), u = 2^-24, the size of the rounding error of the
+//  f64 products themselves.
+//
+//  Host, 1 thread (Host/Benchmarks/bench_gemm.cpp, g++ -O2
+//  -ffp-contract=off, with and without -mfma), GFLOP/s of the equivalent
+//  double operations and max error in ulp of sum(|a_ik b_kj|):
+//
+//                           naive loop       blocked
+//    f64 512x512            0.13   2.3 ulp   0.71   0.25 ulp
+//    c64 256x256            0.21   0.9 ulp   0.32   0.35 ulp
+//    f64 512x512, -mfma     0.16   1.9 ulp   1.00   0.26 ulp
+//    c64 256x256, -mfma     0.32   0.8 ulp   0.65   0.41 ulp
+//
+//  Metal kernel:
+//
+//    kernel void gemm_kernel(device const float2 *A [[ buffer(0) ]],
+//                            device const float2 *B [[ buffer(1) ]],
+//                            device float2 *C [[ buffer(2) ]],
+//                            constant gemm_params &p [[ buffer(3) ]],
+//                            uint2 group [[ threadgroup_position_in_grid ]],
+//                            uint tid [[ thread_index_in_threadgroup ]]) {
+//        threadgroup float2 As[GEMM_BM * GEMM_BK];
+//        threadgroup float2 Bs[GEMM_BK * GEMM_BN];
+//        gemm_threadgroup<gemm_f64_tile<>>(A, B, C, p, As, Bs, group, tid);
+//    }
+//
+//  Dispatch: threadgroups (ceil(N / BN), ceil(M / BM)), threads per
+//  threadgroup (BM / TM) * (BN / TN). The host version (Host/CPUGemm.h) runs
+//  the same blocks on all CPU cores.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __F64GEMM_H
+#define __F64GEMM_H
+
+#include "c64.h"
+#include "f64acc.h"
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Parameters
+// ----------------------------------------------------------------------------
+
+// Default block sizes
+static constant int GEMM_BM = 32;
+static constant int GEMM_BN = 32;
+static constant int GEMM_BK = 8;
+static constant int GEMM_TM = 4;
+static constant int GEMM_TN = 4;
+
+// Matrix sizes, C = alpha A B + beta C, A: M x K, B: K x N, C: M x N
+struct gemm_params {
+    int M;
+    int N;
+    int K;
+    int lda;
+    int ldb;
+    int ldc;
+    float4 alpha;   // f64 in .xy, c64
+    float4 beta;    // f64 in .xy, c64, C is not read if beta = 0
+};
+
+
+// ----------------------------------------------------------------------------
+//  Register tiles
+//
+//  element                 float2 (f64) or float4 (c64)
+//  BM, BN, BK, TM, TN      Block sizes
+//  THREADS                 Threads per threadgroup
+//  accumulate(As, Bs, ..)  Add the products of one step of BK
+//  store(C, ..)            C = alpha acc + beta C
+// ----------------------------------------------------------------------------
+
+// TM x TN tile of an f64 matrix
+template <int BM = GEMM_BM, int BN = GEMM_BN, int BK = GEMM_BK, int TM = GEMM_TM, int TN = GEMM_TN>
+struct gemm_f64_tile {
+    typedef float2 element;
+    enum { bm = BM, bn = BN, bk = BK, THREADS = (BM / TM) * (BN / TN) };
+
+    float4 acc[TM * TN];
+
+    gemm_f64_tile() {
+        for (int i = 0; i < TM * TN; i++) acc[i] = float4(0.0f);
+    }
+
+    /// Add the products of the blocks As (BK x BM, column of A contiguous) and Bs (BK x BN)
+    /// - Parameters:
+    ///   - tid: Thread in the threadgroup, owns rows TM * (tid / (BN / TN)) ... and columns TN * (tid % (BN / TN)) ...
+    void accumulate(threadgroup const float2 *As, threadgroup const float2 *Bs, uint tid) {
+        int m0 = int(tid) / (BN / TN) * TM, n0 = int(tid) % (BN / TN) * TN;
+        float2 s[TM * TN];
+        for (int e = 0; e < TM * TN; e++) s[e] = float2(0.0f);
+        for (int k = 0; k < BK; k++) {
+            float2 a[TM], b[TN];
+            for (int i = 0; i < TM; i++) a[i] = As[k * BM + m0 + i];
+            for (int j = 0; j < TN; j++) b[j] = Bs[k * BN + n0 + j];
+            for (int i = 0; i < TM; i++) {
+                for (int j = 0; j < TN; j++) s[i * TN + j] = fsum_add_mul(s[i * TN + j], a[i], b[j]);
+            }
+        }
+        for (int e = 0; e < TM * TN; e++) acc[e] = acc_add(acc[e], s[e]);
+    }
+
+    /// Store the tile of thread tid into the block (row, col) of C
+    void store(device float2 *C, constant gemm_params &p, int row, int col, uint tid) {
+        int m0 = row + int(tid) / (BN / TN) * TM, n0 = col + int(tid) % (BN / TN) * TN;
+        for (int i = 0; i < TM && m0 + i < p.M; i++) {
+            for (int j = 0; j < TN && n0 + j < p.N; j++) {
+                device float2 *c = C + (m0 + i) * p.ldc + n0 + j;
+                float2 r = mul_f64(p.alpha.xy, acc_value(acc[i * TN + j]));
+                *c = p.beta.x == 0.0f ? r : add_f64(r, mul_f64(p.beta.xy, *c));
+            }
+        }
+    }
+};
+
+// TM x TN tile of a c64 matrix, one accumulator for the real and one for the
+// imaginary part of every element
+template <int BM = GEMM_BM, int BN = GEMM_BN, int BK = GEMM_BK, int TM = GEMM_TM, int TN = GEMM_TN>
+struct gemm_c64_tile {
+    typedef float4 element;
+    enum { bm = BM, bn = BN, bk = BK, THREADS = (BM / TM) * (BN / TN) };
+
+    float4 re[TM * TN];
+    float4 im[TM * TN];
+
+    gemm_c64_tile() {
+        for (int i = 0; i < TM * TN; i++) {
+            re[i] = float4(0.0f);
+            im[i] = float4(0.0f);
+        }
+    }
+
+    void accumulate(threadgroup const float4 *As, threadgroup const float4 *Bs, uint tid) {
+        int m0 = int(tid) / (BN / TN) * TM, n0 = int(tid) % (BN / TN) * TN;
+        float4 s[TM * TN];
+        for (int e = 0; e < TM * TN; e++) s[e] = float4(0.0f);
+        for (int k = 0; k < BK; k++) {
+            float4 a[TM], b[TN];
+            for (int i = 0; i < TM; i++) a[i] = As[k * BM + m0 + i];
+            for (int j = 0; j < TN; j++) b[j] = Bs[k * BN + n0 + j];
+            for (int i = 0; i < TM; i++) {
+                for (int j = 0; j < TN; j++) {
+                    // (ar + i ai) (br + i bi) = ar br - ai bi + i (ar bi + ai br)
+                    int e = i * TN + j;
+                    s[e].xy = fsum_add_mul(fsum_add_mul(s[e].xy, a[i].xy, b[j].xy), -a[i].zw, b[j].zw);
+                    s[e].zw = fsum_add_mul(fsum_add_mul(s[e].zw, a[i].xy, b[j].zw), a[i].zw, b[j].xy);
+                }
+            }
+        }
+        for (int e = 0; e < TM * TN; e++) {
+            re[e] = acc_add(re[e], s[e].xy);
+            im[e] = acc_add(im[e], s[e].zw);
+        }
+    }
+
+    void store(device float4 *C, constant gemm_params &p, int row, int col, uint tid) {
+        int m0 = row + int(tid) / (BN / TN) * TM, n0 = col + int(tid) % (BN / TN) * TN;
+        for (int i = 0; i < TM && m0 + i < p.M; i++) {
+            for (int j = 0; j < TN && n0 + j < p.N; j++) {
+                device float4 *c = C + (m0 + i) * p.ldc + n0 + j;
+                float4 v = float4(acc_value(re[i * TN + j]), acc_value(im[i * TN + j]));
+                float4 r = mul_c64(p.alpha, v);
+                *c = p.beta.x == 0.0f && p.beta.z == 0.0f ? r : add_c64(r, mul_c64(p.beta, *c));
+            }
+        }
+    }
+};
+
+
+// ----------------------------------------------------------------------------
+//  Threadgroup blocks
+// ----------------------------------------------------------------------------
+
+/// Load the blocks of A (rows row ..., columns k0 ...) and B (rows k0 ...,
+/// columns col ...) into threadgroup memory, zero outside the matrices
+/// - Parameters:
+///   - As: BK x BM, transposed so that a thread reads its TM rows contiguously
+///   - Bs: BK x BN
+///   - tid: Thread in the threadgroup, all threads share the loads
+template <typename Tile>
+static void gemm_load(device const typename Tile::element *A, device const typename Tile::element *B,
+                      constant gemm_params &p, int row, int col, int k0,
+                      threadgroup typename Tile::element *As, threadgroup typename Tile::element *Bs, uint tid) {
+    typedef typename Tile::element T;
+    const int BM = Tile::bm, BN = Tile::bn, BK = Tile::bk;
+    // Consecutive threads read consecutive elements of a row
+    for (int e = int(tid); e < BM * BK; e += Tile::THREADS) {
+        int m = e / BK, k = e % BK;
+        As[k * BM + m] = row + m < p.M && k0 + k < p.K ? A[(row + m) * p.lda + k0 + k] : T(0.0f);
+    }
+    for (int e = int(tid); e < BK * BN; e += Tile::THREADS) {
+        int k = e / BN, n = e % BN;
+        Bs[k * BN + n] = k0 + k < p.K && col + n < p.N ? B[(k0 + k) * p.ldb + col + n] : T(0.0f);
+    }
+}
+
+#ifdef __METAL_VERSION__
+/// Block (group.y, group.x) of C, executed by all threads of a threadgroup
+/// - Parameters:
+///   - As, Bs: Threadgroup memory for BM * BK and BK * BN elements
+template <typename Tile>
+static void gemm_threadgroup(device const typename Tile::element *A, device const typename Tile::element *B,
+                             device typename Tile::element *C, constant gemm_params &p,
+                             threadgroup typename Tile::element *As, threadgroup typename Tile::element *Bs,
+                             uint2 group, uint tid) {
+    int row = int(group.y) * Tile::bm, col = int(group.x) * Tile::bn;
+    Tile t;
+    for (int k0 = 0; k0 < p.K; k0 += Tile::bk) {
+        gemm_load<Tile>(A, B, p, row, col, k0, As, Bs, tid);
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+        t.accumulate(As, Bs, tid);
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+    t.store(C, p, row, col, tid);
+}
+#endif
+
+#endif
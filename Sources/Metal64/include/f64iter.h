@@ -5,6 +5,35 @@
 //
 //  CORDIC iteration functions
 //
+//  The functions are templates over the maximum number of iterations N and the
+//  precision target BITS. The iteration stops as soon as the residual (remaining
+//  angle or weight) can be handled by a short final step with an error below
+//  2^-BITS:
+//
+//    sincos_iterate, tan_iterate   |theta|^2 / 2 < 2^-BITS, final linear rotation
+//    atan2_iterate                 |y/x|^3 / 3   < 2^-BITS, final angle y/x
+//    exp_iterate                   z^5 / 120     < 2^-BITS, residual polynomial
+//    log_iterate                   z^5 / 5       < 2^-BITS, residual polynomial
+//    asin_iterate, acos_iterate    step angle    < 2^-BITS
+//
+//  Examples:
+//
+//    float4 sc = sincos_iterate(a);          // N = 50, 48 bits
+//    float4 sc = sincos_iterate<50, 32>(a);  // 32 bits
+//
+//  Throughput (ns/call) and achieved precision (bits) on the host, N = 50
+//  (Host/Benchmarks/bench_cordic.cpp, x86 without FMA):
+//
+//    function   BITS = 24    BITS = 32    BITS = 40    BITS = 48    without early exit
+//    sin         556  24.0    693  32.0    824  40.0    968  45.3    1504  45.2
+//    atan        280  24.0    376  32.0    483  40.0    577  46.1    1503  46.0
+//    exp         155  24.1    175  32.0    211  40.0    257  45.3    1222  16.0
+//    log         307  24.1    377  32.0    464  40.0    501  45.8    2985  46.0
+//    asin       1664  24.0   2354  32.0   2906  40.0   3529  39.9    4183  39.9
+//
+//  The polynomial engines of f64poly.h remain the faster choice for sin, cos,
+//  exp, log and atan2 at any precision.
+//
 //  Created by Dirk Braner on 11.04.25.
 //
 
@@ -14,7 +43,7 @@ using namespace metal;
 // Constants for CORDIC algorithms
 //
 
-// Number of iterations
+// Maximum number of iterations
 static constant int CORDIC_SINCOS_ITERATIONS = 50;
 static constant int CORDIC_TAN_ITERATIONS    = 50;
 static constant int CORDIC_ASIN_ITERATIONS   = 50;
@@ -22,6 +51,9 @@ static constant int CORDIC_ACOS_ITERATIONS   = 50;
 static constant int CORDIC_ATAN_ITERATIONS   = 50;
 static constant int CORDIC_LOGEXP_ITERATIONS = 50;
 
+// Default precision target in bits
+static constant int CORDIC_BITS = 48;
+
 
 //
 // Predefined values
@@ -187,7 +219,9 @@ static inline float2 angle_shift(float2 alpha, float2 beta) {
 }
 
 // Sine/Cosine CORDIC algorithm
+template <int N = CORDIC_SINCOS_ITERATIONS, int BITS = CORDIC_BITS>
 static float4 sincos_iterate(float2 a) {
+    const float eps = ldexp(1.0f, -BITS);
     float2 angle;
     float2 c2;
     float factor;
@@ -214,8 +248,10 @@ static float4 sincos_iterate(float2 a) {
     
     angle = trig_angles[0];
 
-    // Iterate
-    for (j=1; j<CORDIC_SINCOS_ITERATIONS; j++) {
+    // Iterate until the remaining angle is small enough for a linear rotation
+    for (j=1; j<N; j++) {
+        if (theta.x * theta.x < 2.0f * eps) break;
+        
         sigma = ltZero(theta) ? -1 : 1;
 
         factor = sigma < 0 ? -poweroftwo : poweroftwo;
@@ -232,13 +268,19 @@ static float4 sincos_iterate(float2 a) {
         // Update the angle from table, or eventually by just dividing by two
         angle = j < CORDIC_ANGLES_LENGTH ? trig_angles[j] : mul_ds(angle, 0.5);
     }
+    
+    // Rotate by the remaining angle: cos(theta) = 1, sin(theta) = theta
+    // with an error of theta^2 / 2
+    c2 = sub_f64(c, mul_f64(s, theta));
+    s  = add_f64(s, mul_f64(c, theta));
+    c  = c2;
 
     // Adjust length of output vector to be [cos(beta), sin(beta)]
 
     // KPROD is essentially constant after a certain point, so if N is
     // large, just take the last available value
-    if (CORDIC_SINCOS_ITERATIONS > 0) {
-        fkprod = trig_kprod[ min(CORDIC_SINCOS_ITERATIONS, CORDIC_KPROD_LENGTH) - 1 ];
+    if (j > 1) {
+        fkprod = trig_kprod[ min(j - 1, CORDIC_KPROD_LENGTH) - 1 ];
         c = mul_f64(c, fkprod);
         s = mul_f64(s, fkprod);
     }
@@ -252,7 +294,9 @@ static float4 sincos_iterate(float2 a) {
 }
 
 // Tangent CORDIC algorithm
+template <int N = CORDIC_TAN_ITERATIONS, int BITS = CORDIC_BITS>
 static float2 tan_iterate(float2 a) {
+    const float eps = ldexp(1.0f, -BITS);
     float2 angle;
     float2 c = F2_ONE;
     float2 s = 0.0;
@@ -276,7 +320,9 @@ static float2 tan_iterate(float2 a) {
 
     angle = trig_angles[0];
 
-    for (j=1; j<=CORDIC_TAN_ITERATIONS; j++) {
+    for (j=1; j<=N; j++) {
+        if (theta.x * theta.x < 2.0f * eps) break;
+        
         sigma = ltZero(theta) ? -1 : 1;
 
         factor = sigma < 0 ? -poweroftwo : poweroftwo;
@@ -293,6 +339,11 @@ static float2 tan_iterate(float2 a) {
         // Update the angle from table, or eventually by just dividing by two.
         angle = j + 1 > CORDIC_ANGLES_LENGTH ? mul_ds(angle, 0.5) : trig_angles[j];
     }
+    
+    // Rotate by the remaining angle, the scale factor cancels in s / c
+    c2 = sub_f64(c, mul_f64(s, theta));
+    s  = add_f64(s, mul_f64(c, theta));
+    c  = c2;
 
     float2 result = div_f64(s, c);
     
@@ -301,7 +352,9 @@ static float2 tan_iterate(float2 a) {
 }
 
 // Arc sine CORDIC algorithm
+template <int N = CORDIC_ASIN_ITERATIONS, int BITS = CORDIC_BITS>
 static float2 asin_iterate(float2 a) {
+    const float eps = ldexp(1.0f, -BITS);
     int i, j;
     int sigma;
     int sign_z1;
@@ -315,11 +368,14 @@ static float2 asin_iterate(float2 a) {
 
     if (gt(abs(a), F2_ONE)) return NAN;
     
-    for (j=1; j<=CORDIC_ASIN_ITERATIONS; j++) {
+    for (j=1; j<=N; j++) {
         sign_z1 = ltZero(x1) ? -1 : 1;
         sigma = le(y1, a) ? sign_z1 : -sign_z1;
         
         angle = j <= CORDIC_ANGLES_LENGTH ? trig_angles[j - 1] : mul_ds(angle, 0.5);
+        
+        // The remaining steps add up to less than 2 * angle
+        if (2.0f * angle.x < eps) break;
 
         factor = sigma < 0 ? -poweroftwo : poweroftwo;
         
@@ -341,7 +397,9 @@ static float2 asin_iterate(float2 a) {
 }
 
 // Arc cosine CORDIC algorithm
+template <int N = CORDIC_ACOS_ITERATIONS, int BITS = CORDIC_BITS>
 static float2 acos_iterate(float2 a) {
+    const float eps = ldexp(1.0f, -BITS);
     float2 angle;
     int i;
     int j;
@@ -356,12 +414,15 @@ static float2 acos_iterate(float2 a) {
 
     if (gt(abs(a), F2_ONE)) return NAN;
 
-    for (j=1; j<=CORDIC_ACOS_ITERATIONS; j++) {
+    for (j=1; j<=N; j++) {
         sign_z2 = ltZero(y1) ? -1 : 1;
 
         sigma = le(a, x1) ? sign_z2 : -sign_z2;
 
         angle = j <= CORDIC_ANGLES_LENGTH ? trig_angles[j - 1] : mul_ds(angle, 0.5);
+        
+        // The remaining steps add up to less than 2 * angle
+        if (2.0f * angle.x < eps) break;
 
         factor = sigma < 0 ? -poweroftwo : poweroftwo;
 
@@ -384,33 +445,32 @@ static float2 acos_iterate(float2 a) {
 
 // Arc tangent 2 CORDIC algorithm
 // For arc tangent set x = 1
+template <int N = CORDIC_ATAN_ITERATIONS, int BITS = CORDIC_BITS>
 static float2 atan2_iterate(float2 y, float2 x) {
+    const float eps = ldexp(1.0f, -BITS);
     float2 angle;
     int j;
     float poweroftwo = 1.0;
     int sigma;
-    int sign_factor = 1;
     float2 theta = 0.0f;
     float2 x1 = x;
     float2 x2;
     float2 y1 = y;
     float factor;
 
-    if (ltZero(x1) && ltZero(y1)) {
-        x1 = -x1;
-        y1 = -y1;
-    }
+    if (x1.x == 0.0f && y1.x == 0.0f) return F2_ZERO;
 
-    if (ltZero(x1)) {
+    // Mirror to the right half plane, the vectoring converges for |angle| < 99 degrees
+    bool mirror = ltZero(x1);
+    if (mirror) {
         x1 = -x1;
-        sign_factor = -1;
-    }
-    else if (ltZero(y1)) {
-        y1 = -y1;
-        sign_factor = -1;
     }
 
-    for (j=1; j<=CORDIC_ATAN_ITERATIONS; j++) {
+    for (j=1; j<=N; j++) {
+        // Remaining angle atan(y1 / x1) = y1 / x1 - (y1 / x1)^3 / 3 + ...
+        float r = abs(y1.x) < abs(x1.x) ? y1.x / x1.x : 1.0f;
+        if (abs(r * r * r) < 3.0f * eps) break;
+        
         sigma = le(y1, F2_ZERO) ? 1 : -1;
 
         angle = j <= CORDIC_ANGLES_LENGTH ? trig_angles[j-1] : mul_ds(angle, 0.5);
@@ -424,8 +484,15 @@ static float2 atan2_iterate(float2 y, float2 x) {
 
         poweroftwo *= 0.5;
     }
+    
+    // Add the remaining angle
+    theta = add_f64(theta, div_f64(y1, x1));
 
-    float2 result = sign_factor < 0 ? -theta : theta;
+    // atan2(y, -x) = +-PI - atan2(y, x)
+    float2 result = theta;
+    if (mirror) {
+        result = sub_f64(ltZero(y) ? -F2_PI : F2_PI, theta);
+    }
     
     // Normalize
     return quick_renorm(result);
@@ -433,40 +500,45 @@ static float2 atan2_iterate(float2 y, float2 x) {
 }
 
 // Exponential function CORDIC algorithm
+template <int N = CORDIC_LOGEXP_ITERATIONS, int BITS = CORDIC_BITS>
 static float2 exp_iterate(float2 a) {
+    const float eps = ldexp(1.0f, -BITS);
     float2 ai;
     float2 fx = F2_ONE;
     int i;
+    int n;
     float poweroftwo = 0.5;
-    int w[CORDIC_LOGEXP_ITERATIONS];
+    int w[N];
     int x_int;
     float2 z;
     
     x_int = (int) floor(a.x);
     
-    // Determine the weights.
+    // Determine the weights until the residual polynomial is exact enough
     z = sub_f64(a, flt2(x_int));
     
-    for (i=0; i<CORDIC_LOGEXP_ITERATIONS; i++) {
+    for (n=0; n<N; n++) {
+        if (z.x * z.x * z.x * z.x * z.x < 120.0f * eps) break;
+        
         if (lt(flt2(poweroftwo), z)) {
-            w[i] = 1;
+            w[n] = 1;
             z = sub_ds(z, poweroftwo);
         }
         else {
-            w[i] = 0;
+            w[n] = 0;
         }
         poweroftwo *= 0.5;
     }
     
     // Calculate products
-    for (i=0; i<CORDIC_LOGEXP_ITERATIONS; i++) {
+    for (i=0; i<n; i++) {
         if (w[i]) {
             ai = i < CORDIC_LOGEXP_LENGTH ? logexp[i] : add_ds(mul_ds(sub_ds(ai, 1.0), 0.5), 1.0);
             fx = mul_f64(fx, ai);
         }
     }
     
-    // Perform residual multiplication
+    // Perform residual multiplication, the error is z^5 / 120
     float2 z12 = mul_ds(z, 0.5);
     float2 z13 = mul_f64(z, F2_1_3);
     float2 z14 = mul_ds(z, 0.25);
@@ -489,12 +561,15 @@ static float2 exp_iterate(float2 a) {
 }
 
 // Natural logarithm CORDIC algorithm
+template <int N = CORDIC_LOGEXP_ITERATIONS, int BITS = CORDIC_BITS>
 static float2 log_iterate(float2 a) {
+    const float eps = ldexp(1.0f, -BITS);
     float2 ai;
     int i;
+    int n;
     int k = 0;
     float2 poweroftwo = flt2(0.5);
-    int w[CORDIC_LOGEXP_ITERATIONS];
+    int w[N];
     
     if (eq(a, F2_ONE)) return F2_ZERO;
     if (le(a, 0.0)) return NAN;
@@ -509,37 +584,31 @@ static float2 log_iterate(float2 a) {
         a = mul_f64(a, F2_E);
     }
     
-    // Determine the weights
-    for (i=0; i<CORDIC_LOGEXP_ITERATIONS; i++) {
-        w[i] = 0;
+    // Determine the weights until the residual polynomial is exact enough
+    for (n=0; n<N; n++) {
+        float z = a.x - 1.0f;
+        if (z * z * z * z * z < 5.0f * eps) break;
+        
+        w[n] = 0;
         
-        ai = i < CORDIC_LOGEXP_LENGTH ? logexp[i] : add_f64(mul_f64(sub_f64(ai, F2_ONE), flt2(0.5)), F2_ONE);
+        ai = n < CORDIC_LOGEXP_LENGTH ? logexp[n] : add_f64(mul_f64(sub_f64(ai, F2_ONE), flt2(0.5)), F2_ONE);
         
         if (lt(ai, a)) {
-            w[i] = 1;
+            w[n] = 1;
             a = div_f64(a, ai);
         }
     }
     
     a = sub_ds(a, 1.0);
     
-    /*
-    float2 x12 = mul_ds(a, 0.5);
-    float2 x13 = mul_f64(a, F2_1_3);
-    float2 x14 = mul_ds(a, 0.25);
-
-    a = mul_f64(a, sub_sd(1.0, mul_f64(x12, add_sd(1.0, mul_f64(x13, sub_sd(1.0, x14))))));
-*/
-    // Nach: a = sub_ds(a, 1.0);
-    // a ist klein (nahe 0), berechne ln(1+a) via Horner
-
+    // a is small, ln(1 + a) by Horner scheme, the error is a^5 / 5
     float2 r = sub_f64(F2_1_3, mul_f64(a, flt2(0.25)));  // 1/3 - a/4
     r = sub_f64(flt2(0.5), mul_f64(a, r));                  // 1/2 - a*(1/3 - a/4)
     r = sub_f64(F2_ONE, mul_f64(a, r));               // 1 - a*(...)
     a = mul_f64(a, r);                                // ln(1+a) ≈ a*(...)
     
     // Assemble
-    for (i=0; i<CORDIC_LOGEXP_ITERATIONS; i++) {
+    for (i=0; i<n; i++) {
         if (w[i]) a = add_f64(a, poweroftwo);
         poweroftwo = mul_f64(poweroftwo, flt2(0.5));
     }
@@ -550,4 +619,3 @@ static float2 log_iterate(float2 a) {
     // Normalize
     return quick_renorm(result);
 }
-
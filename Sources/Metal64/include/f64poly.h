@@ -0,0 +1,784 @@
+//
+//  f64poly.h
+//
+//  Part of Metal64
+//
+//  Table driven polynomial function engines
+//
+//  The argument is reduced to a small interval around a table point,
+//  the function is evaluated by a short polynomial and the result is
+//  reconstructed with the tabulated function values.
+//
+//  Created by Dirk Braner on 18.04.26.
+//
+
+#ifndef __F64POLY_H
+#define __F64POLY_H
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Constants
+// ----------------------------------------------------------------------------
+
+// PI / 2 as 4 float words for Cody-Waite argument reduction
+static constant float4 F4_PI_2 = float4(1.5707964, -4.371139e-08, -1.7151245e-15, 1.0562999e-23);
+
+static constant float F_2_PI_INV = 0.63661975;  // 2 / PI
+
+// LOG(2) / 64 as 3 float words for argument reduction of exp()
+static constant float4 F4_LN2_64 = float4(0.010830425, -2.9760222e-11, -1.3723725e-18, 0.0);
+
+static constant float F_64_LN2 = 92.33248;      // 64 / LOG(2)
+
+// LOG(2) as 4 float words
+static constant float4 F4_LN2 = float4(0.6931472, -1.9046542e-09, -8.783184e-17, 3.0618407e-24);
+
+
+// ----------------------------------------------------------------------------
+//  Sine / Cosine
+// ----------------------------------------------------------------------------
+
+// Lookup table for sincos_poly()
+//
+// Building the table (starting with index 0):
+//
+//   for j=0..n-1: x[j] = float4(sin(j / 64), cos(j / 64))
+//
+// Reduced arguments are in [-PI/4, PI/4], so j <= 51
+//
+static constant int SINCOS_TABLE_LENGTH = 53;
+static constant float4 sincos_table[SINCOS_TABLE_LENGTH] = {
+    float4(0.0, 0.0, 1.0, 0.0),
+    float4(0.015624364, 3.1820183e-10, 0.9998779, 2.4835067e-09),
+    float4(0.031244913, 8.6922863e-10, 0.9995118, -1.9869509e-08),
+    float4(0.046857838, -1.8394607e-09, 0.99890155, 2.2337009e-08),
+    float4(0.062459316, 1.7377297e-09, 0.99804753, -1.9950994e-08),
+    float4(0.078045554, -3.0691276e-09, 0.9969498, 2.1677644e-09),
+    float4(0.09361273, 7.324306e-10, 0.9956087, -9.428162e-10),
+    float4(0.109157056, 1.2589436e-09, 0.9940245, 1.0623159e-10),
+    float4(0.12467473, 3.3823475e-09, 0.9921977, -2.5164928e-08),
+    float4(0.14016198, -3.87116e-09, 0.9901286, 1.1614583e-08),
+    float4(0.15561499, 5.757832e-09, 0.98781776, 1.9534246e-08),
+    float4(0.17103001, 7.2780533e-09, 0.9852658, 2.6302045e-08),
+    float4(0.18640329, 7.3249757e-09, 0.9824733, -7.071859e-10),
+    float4(0.20173107, -7.0744828e-09, 0.9794409, 2.4210054e-08),
+    float4(0.21700957, 6.9201294e-09, 0.97616947, 6.896284e-09),
+    float4(0.23223512, -1.3524605e-10, 0.9726597, -2.8824484e-08),
+    float4(0.24740396, -5.1457687e-09, 0.9689124, -9.463682e-10),
+    float4(0.2625124, 1.3923969e-08, 0.9649286, -7.90939e-09),
+    float4(0.27755675, 4.4482316e-09, 0.9607092, 2.880505e-08),
+    float4(0.29253334, 3.953412e-09, 0.9562553, 6.8088615e-09),
+    float4(0.30743852, -7.9969045e-09, 0.95156795, 1.8363973e-10),
+    float4(0.32226864, -4.6011746e-09, 0.94664824, 2.0796637e-08),
+    float4(0.33702007, -3.3847997e-10, 0.94149745, 1.8021375e-08),
+    float4(0.35168922, 9.520021e-09, 0.9361168, -2.346287e-09),
+    float4(0.36627254, -9.814328e-09, 0.9305076, 2.160485e-08),
+    float4(0.38076642, -1.2564082e-08, 0.92467123, 2.8766689e-08),
+    float4(0.39516732, 9.274213e-09, 0.91860914, 1.34914515e-08),
+    float4(0.40947178, -3.0084268e-09, 0.91232276, 2.5243821e-08),
+    float4(0.42367625, 4.838826e-09, 0.9058137, -1.0574308e-08),
+    float4(0.4377773, -7.7370625e-09, 0.89908344, 5.0247078e-09),
+    float4(0.45177147, 3.5675658e-09, 0.8921337, -1.340156e-08),
+    float4(0.46565536, -1.0060424e-08, 0.88496614, 2.1501119e-08),
+    float4(0.47942555, -1.0902938e-08, 0.87758255, 1.1841545e-08),
+    float4(0.49307868, 6.907564e-09, 0.86998475, -2.7920892e-08),
+    float4(0.50661147, -1.1593518e-08, 0.86217445, 2.8583715e-08),
+    float4(0.52002054, -2.5752342e-09, 0.85415375, 1.95042e-09),
+    float4(0.53330266, 8.779245e-09, 0.8459245, 2.5803721e-09),
+    float4(0.5464546, -1.5211956e-09, 0.8374887, 1.2970244e-08),
+    float4(0.55947316, -2.5681649e-08, 0.8288485, 6.431042e-09),
+    float4(0.5723551, -2.33373e-08, 0.8200059, 6.1899588e-09),
+    float4(0.58509725, 1.9617861e-08, 0.8109631, 2.527075e-08),
+    float4(0.59769666, -2.7410456e-08, 0.80172235, 6.3620598e-09),
+    float4(0.6101501, -2.1724867e-08, 0.79228586, 9.2370195e-11),
+    float4(0.6224546, -2.3422523e-08, 0.78265595, -1.4334689e-08),
+    float4(0.6346071, 3.3703718e-09, 0.77283496, -1.0493494e-08),
+    float4(0.64660466, 1.24179955e-08, 0.76282525, 2.5084965e-08),
+    float4(0.6584444, -4.691483e-09, 0.7526294, -2.6881555e-08),
+    float4(0.6701234, -1.7830823e-08, 0.7422497, -1.7906442e-09),
+    float4(0.6816388, -1.7232678e-08, 0.73168886, 1.1795269e-08),
+    float4(0.69298774, -1.2793508e-08, 0.72094935, 2.915813e-08),
+    float4(0.7041675, 2.6217412e-08, 0.7100339, -1.0019125e-08),
+    float4(0.7151754, -6.9795227e-09, 0.69894505, -3.874086e-09),
+    float4(0.72600865, 1.6199655e-09, 0.68768555, 1.2961319e-08)
+};
+
+// Reduce a by multiples of PI / 2: a = k * PI/2 + r, |r| <= PI/4
+// k = rint(a * 2 / PI) must be calculated by caller. Only for |a| up to
+// SINCOS_REDUCE_LARGE: the 4 words of PI/2 leave |r| > PI/4 for large k and
+// int(k) overflows above 2^31, larger arguments go to reduce_pi_2_large()
+static inline float2 reduce_pi_2(float2 a, float fk) {
+    if (fk == 0.0f) return a;
+    
+    // k * PI/2 is subtracted word by word (Cody-Waite), the products of the
+    // first 3 words are exact, the 4th is below the rounding of the result
+    float2 r = add_f64_accurate(a, -prod(fk, F4_PI_2.x));
+    r = add_f64_accurate(r, -prod(fk, F4_PI_2.y));
+    r = add_f64_accurate(r, -prod(fk, F4_PI_2.z));
+    return sub_ds(r, fk * F4_PI_2.w);
+}
+
+// 2 / PI in chunks of 24 bits for the reduction of large arguments
+//
+// Building the table (starting with index 0):
+//
+//   2 / PI = sum(two_over_pi[i] * 2^(-24 * (i + 1)))
+//
+// Floats up to 2^128 need chunks i0 <= 4 .. i0 + 4
+//
+static constant int TWO_OVER_PI_LENGTH = 9;
+static constant float two_over_pi[TWO_OVER_PI_LENGTH] = {
+    10680707.0, 7228996.0, 1387004.0, 2578385.0,
+    16069853.0, 12639074.0, 9804092.0, 4427841.0, 16666979.0
+};
+
+// Arguments above are reduced with reduce_pi_2_large()
+static constant float SINCOS_REDUCE_LARGE = 65536.0f;
+
+// Reduced argument: a = k * PI/2 + r, |r| <= PI/4
+struct reduced_t {
+    float2 r;
+    int k;
+};
+
+// Add float to a 3 level sum, .x and .y are exact (see acc_add_f() in f64acc.h)
+static inline float4 reduce_add(float4 acc, float b) {
+    float s = acc.x + b;
+    float v = s - acc.x;
+    float e = (acc.x - (s - v)) + (b - v);
+    float c = acc.y + e;
+    float w = c - acc.y;
+    float f = (acc.y - (c - w)) + (e - w);
+    return float4(s, c, acc.z + f, 0.0f);
+}
+
+// Payne-Hanek reduction of large arguments, accurate up to the float range
+//
+// Every word v = M * 2^E (M integer < 2^24) of a is multiplied by the chunks
+// of 2/PI. Chunks with E - 24 * (i + 1) >= 2 only add multiples of 4 and
+// are skipped, the next 5 chunks give the fraction to 2^-71. The products
+// M * chunk are exact, their parts are reduced mod 4 and split into integer
+// and fraction exactly, only the sum of the fractions is rounded.
+static reduced_t reduce_pi_2_large(float2 a) {
+    float4 frac = float4(0.0f);
+    int k = 0;
+    
+    for (int w = 0; w < 2; w++) {
+        float v = w == 0 ? a.x : a.y;
+        float av = abs(v);
+        if (av < FLT_MIN) continue;
+        
+        int e = (int)((as_type<uint>(av) >> 23) & 0xFF) - 150;
+        float m = ldexp(av, -e);
+        int i0 = e > 1 ? (e + 22) / 24 - 1 : 0;
+        
+        for (int i = i0; i < i0 + 5; i++) {
+            float2 p = prod(m, two_over_pi[i]);
+            int s = e - 24 * (i + 1);
+            for (int j = 0; j < 2; j++) {
+                float t = ldexp(j == 0 ? p.x : p.y, s);
+                // Exact only for |t| >= 4, small negative parts would lose bits
+                if (abs(t) >= 4.0f) t = t - 4.0f * floor(t * 0.25f);
+                float n = rint(t);
+                k += v < 0.0f ? -int(n) : int(n);
+                frac = reduce_add(frac, v < 0.0f ? n - t : t - n);
+            }
+        }
+    }
+    
+    // Nearest quadrant, the fraction is in [-1/2, 1/2] afterwards
+    float n1 = rint(frac.x);
+    float2 f = add_ds(add_ds(float2(frac.x - n1, 0.0f), frac.y), frac.z);
+    float n2 = rint(f.x);
+    f = sumq(f.x - n2, f.y);
+    
+    reduced_t red;
+    red.r = mul_f64(f, float2(F4_PI_2.x, F4_PI_2.y));
+    red.k = k + int(n1) + int(n2);
+    return red;
+}
+
+// sin(t) = t + t^3 * (-1/6 + t^2/120 - t^4/5040)
+static constant float2 sin_coef_hi[1] = { float2(-0.16666667, 4.967054e-09) };
+static constant float sin_coef_lo[2] = { 1.0f / 120.0f, -1.0f / 5040.0f };
+
+// cos(t) - 1 = t^2 * (-1/2 + t^2/24 - t^4/720)
+static constant float2 cos_coef_hi[1] = { float2(-0.5, 0.0) };
+static constant float cos_coef_lo[2] = { 1.0f / 24.0f, -1.0f / 720.0f };
+
+// Sine and cosine of |t| <= 1/128
+// Returns sin(t) and cos(t) - 1
+static inline float4 sincos_kernel(float2 t) {
+    float2 t2 = sqr_f64(t);
+    float2 s = add_f64(t, mul_f64(mul_f64(t, t2), poly_f64(t2, sin_coef_hi, sin_coef_lo)));
+    float2 c = mul_f64(t2, poly_f64(t2, cos_coef_hi, cos_coef_lo));
+    return float4(s, c);
+}
+
+// Sine and cosine of |r| <= PI/4: returns float4(sin(r), cos(r))
+// r = j/64 + t
+static inline float4 sincos_reduced(float2 r) {
+    float fj = rint(r.x * 64.0f);
+    float2 t = sub_ds(r, fj * (1.0f / 64.0f));
+    
+    float4 st = sincos_kernel(t);
+    
+    // Bounded for arguments slightly beyond PI/4
+    int j = min(int(abs(fj)), SINCOS_TABLE_LENGTH - 1);
+    float2 sj = fj < 0.0f ? -sincos_table[j].xy : sincos_table[j].xy;
+    float2 cj = sincos_table[j].zw;
+    
+    // sin(x + t) = sin(x) + (sin(x) * (cos(t) - 1) + cos(x) * sin(t))
+    // cos(x + t) = cos(x) + (cos(x) * (cos(t) - 1) - sin(x) * sin(t))
+    float2 s = add_f64(sj, add_f64(mul_f64(sj, st.zw), mul_f64(cj, st.xy)));
+    float2 c = add_f64(cj, sub_f64(mul_f64(cj, st.zw), mul_f64(sj, st.xy)));
+    return float4(s, c);
+}
+
+// Rotate float4(sin(r), cos(r)) by k * PI/2
+static inline float4 sincos_quadrant(float4 sc, int k) {
+    switch (k & 3) {
+        case 1:  return float4(sc.zw, -sc.xy);
+        case 2:  return float4(-sc.xy, -sc.zw);
+        case 3:  return float4(-sc.zw, sc.xy);
+        default: return sc;
+    }
+}
+
+// Sine/Cosine: returns float4(sin(a), cos(a))
+static float4 sincos_poly(float2 a) {
+    if (!isfinite(a.x)) return float4(NAN);
+    
+    // a = k * PI/2 + r
+    if (abs(a.x) > SINCOS_REDUCE_LARGE) {
+        reduced_t red = reduce_pi_2_large(a);
+        return sincos_quadrant(sincos_reduced(red.r), red.k);
+    }
+    
+    float fk = rint(a.x * F_2_PI_INV);
+    float2 r = reduce_pi_2(a, fk);
+    
+    return sincos_quadrant(sincos_reduced(r), int(fk));
+}
+
+
+// ----------------------------------------------------------------------------
+//  Sine / Cosine of multiples of PI and of degrees
+//
+//  The argument is reduced exactly, without division and without the
+//  rounding error of a * PI: only the reduced argument is multiplied by PI.
+// ----------------------------------------------------------------------------
+
+// x mod 4 for integer valued floats, exact
+static inline int mod4(float x) {
+    return int(x - 4.0f * floor(x * 0.25f));
+}
+
+// sin(PI * a), cos(PI * a): returns float4(sinpi(a), cospi(a))
+static float4 sincospi_poly(float2 a) {
+    if (!isfinite(a.x)) return float4(NAN);
+    
+    // 2a = k + r2, |r2| <= 1/2, a = k/2 + r2/2
+    // k is removed from the high part by an exact two-sum. For |a| >= 2^22
+    // the low part may hold further integers, a second step removes them.
+    float2 r = a * 2.0f;
+    int q = 0;
+    while (abs(r.x) > 0.5f) {
+        float k = rint(r.x);
+        r = add_ds(float2(r.y, 0.0f), r.x - k);
+        q += mod4(k);
+    }
+    
+    float4 sc = sincos_reduced(mul_f64(r * 0.5f, F2_PI));
+    return sincos_quadrant(sc, q);
+}
+
+// Sine and cosine of degrees: returns float4(sind(a), cosd(a))
+static float4 sincosd_poly(float2 a) {
+    if (!isfinite(a.x)) return float4(NAN);
+    
+    // a = k * 90 + r, |r| <= 45, 90 * k is exact
+    // The float estimate of k is exact for |a| < 2^24, larger a need a few more steps
+    float2 r = a;
+    int q = 0;
+    while (abs(r.x) > 45.0f) {
+        float k = rint(r.x * (1.0f / 90.0f));
+        r = add_f64(r, -prod(k, 90.0f));
+        q += mod4(k);
+    }
+    
+    float4 sc = sincos_reduced(mul_f64(r, F2_PI_180));
+    return sincos_quadrant(sc, q);
+}
+
+
+// ----------------------------------------------------------------------------
+//  Exponential function
+// ----------------------------------------------------------------------------
+
+// Lookup table for exp_poly()
+//
+// Building the table (starting with index 0):
+//
+//   for j=0..63: x[j] = 2 ^ (j / 64)
+//
+static constant int EXP_TABLE_LENGTH = 64;
+static constant float2 exp2_table[EXP_TABLE_LENGTH] = {
+    float2(1.0, 0.0),
+    float2(1.0108893, -5.7116054e-09),
+    float2(1.0218972, -4.81156e-08),
+    float2(1.0330249, -2.8090893e-08),
+    float2(1.0442737, 4.83347e-08),
+    float2(1.0556452, -4.9071694e-08),
+    float2(1.0671405, -5.933752e-08),
+    float2(1.0787607, 5.4615946e-08),
+    float2(1.0905077, -1.307754e-08),
+    float2(1.1023825, 4.260502e-08),
+    float2(1.1143868, -5.43554e-08),
+    float2(1.1265216, 3.1236414e-08),
+    float2(1.1387886, 5.3862223e-08),
+    float2(1.1511892, 2.1922283e-08),
+    float2(1.1637249, -4.0514415e-08),
+    float2(1.176397, 2.566975e-08),
+    float2(1.1892071, 3.7976353e-08),
+    float2(1.2021568, -5.0697565e-08),
+    float2(1.2152474, -3.267395e-08),
+    float2(1.2284806, -4.1362004e-08),
+    float2(1.2418578, 4.496838e-08),
+    float2(1.2553807, 7.3222375e-09),
+    float2(1.269051, 1.4193333e-09),
+    float2(1.28287, -3.8166217e-08),
+    float2(1.2968396, -4.0189995e-08),
+    float2(1.3109612, -3.4965716e-08),
+    float2(1.3252367, -3.4963733e-08),
+    float2(1.3396676, -3.461674e-08),
+    float2(1.3542556, -1.0123349e-08),
+    float2(1.3690025, -3.845882e-08),
+    float2(1.38391, -5.8755774e-08),
+    float2(1.3989797, 8.689434e-09),
+    float2(1.4142135, 2.4203235e-08),
+    float2(1.4296134, -1.3429929e-08),
+    float2(1.4451808, 3.3242e-08),
+    float2(1.4609178, -3.6286576e-08),
+    float2(1.4768262, -4.500899e-08),
+    float2(1.4929078, -3.42362e-08),
+    float2(1.5091645, -2.4959373e-08),
+    float2(1.5255982, -1.7628569e-08),
+    float2(1.5422108, 8.070905e-09),
+    float2(1.5590044, -2.5764665e-08),
+    float2(1.5759809, -5.6610254e-08),
+    float2(1.5931422, -4.903137e-10),
+    float2(1.6104903, 9.836217e-09),
+    float2(1.6280274, -1.7260083e-08),
+    float2(1.6457555, -5.124972e-08),
+    float2(1.6636766, -3.9202988e-08),
+    float2(1.6817929, -2.4755327e-08),
+    float2(1.7001064, -2.8651472e-08),
+    float2(1.7186193, -4.8496176e-08),
+    float2(1.7373339, -5.8502234e-08),
+    float2(1.7562522, -9.23577e-09),
+    float2(1.7753764, 5.343198e-08),
+    float2(1.7947091, -1.1415045e-08),
+    float2(1.8142521, 3.7362582e-08),
+    float2(1.8340081, -1.1239278e-08),
+    float2(1.8539791, 1.4365612e-08),
+    float2(1.8741677, -4.6630056e-08),
+    float2(1.894576, 2.8103385e-08),
+    float2(1.9152066, 9.845328e-09),
+    float2(1.9360617, 5.3570723e-08),
+    float2(1.9571441, -1.7021804e-08),
+    float2(1.978456, 6.0327263e-09)
+};
+
+// exp(r) - 1 = r + r^2 * (1/2 + r/6 + r^2 * (1/24 + r/120 + r^2/720))
+static constant float2 expm1_coef_hi[2] = { float2(0.5, 0.0), float2(0.16666667, -4.967054e-09) };
+static constant float expm1_coef_lo[3] = { 1.0f / 24.0f, 1.0f / 120.0f, 1.0f / 720.0f };
+
+// exp(r) - 1 for |r| <= LOG(2) / 128
+static inline float2 expm1_kernel(float2 r) {
+    return add_f64(r, mul_f64(sqr_f64(r), poly_f64(r, expm1_coef_hi, expm1_coef_lo)));
+}
+
+// Exponential function
+// x = (64 * m + j) * LOG(2) / 64 + r  =>  exp(x) = 2^m * 2^(j/64) * exp(r)
+static float2 exp_poly(float2 x) {
+    if (isnan(x.x)) return x;
+    if (gt(x, F2_EXPMAX)) return flt2(INFINITY);
+    if (lt(x, F2_EXPMIN)) return F2_ZERO;
+    
+    float fk = rint(x.x * F_64_LN2);
+    
+    // k * LOG(2) / 64 is subtracted word by word, the products are exact
+    float2 r = add_f64_accurate(x, -prod(fk, F4_LN2_64.x));
+    r = add_f64_accurate(r, -prod(fk, F4_LN2_64.y));
+    r = sub_ds(r, fk * F4_LN2_64.z);
+    
+    int k = int(fk);
+    int m = k >> 6;
+    float2 t = exp2_table[k & 63];
+    
+    // 2^(j/64) * exp(r) = t + t * (exp(r) - 1)
+    float2 e = add_f64(t, mul_f64(t, expm1_kernel(r)));
+    return float2(ldexp(e.x, m), ldexp(e.y, m));
+}
+
+
+// ----------------------------------------------------------------------------
+//  Hyperbolic functions
+// ----------------------------------------------------------------------------
+
+// sinh(x) = x + x^3 * (1/3! + x^2/5! + x^4/7! + x^6 * (1/9! + x^2/11! + x^4/13!))
+static constant float2 sinh_coef_hi[3] = {
+    float2(0.16666667, -4.967054e-09),      // 1/3!
+    float2(0.008333334, -4.346172e-10),     // 1/5!
+    float2(0.0001984127, -2.7255969e-12)    // 1/7!
+};
+static constant float sinh_coef_lo[3] = { 1.0f / 362880.0f, 1.0f / 39916800.0f, 1.0f / 6227020800.0f };
+
+// sinh(x) for |x| <= 1/2, where (exp(x) - exp(-x)) / 2 cancels
+static inline float2 sinh_kernel(float2 x) {
+    float2 x2 = sqr_f64(x);
+    return add_f64(x, mul_f64(mul_f64(x, x2), poly_f64(x2, sinh_coef_hi, sinh_coef_lo)));
+}
+
+// Hyperbolic sine and cosine: returns float4(sinh(a), cosh(a))
+// One exponential for both, exp(-|a|) = 1 / exp(|a|)
+static float4 sinhcosh_poly(float2 a) {
+    if (isnan(a.x)) return float4(a, a);
+    
+    bool neg = a.x < 0.0f;
+    float2 x = neg ? -a : a;
+    
+    float2 e = exp_poly(x);
+    if (isinf(e.x)) return float4(neg ? -INFINITY : INFINITY, 0.0f, INFINITY, 0.0f);
+    float2 ei = div_f64(F2_ONE, e);
+    
+    float2 s = x.x <= 0.5f ? sinh_kernel(x) : mul_ds(sub_f64(e, ei), 0.5f);
+    float2 c = mul_ds(add_f64(e, ei), 0.5f);
+    return float4(neg ? -s : s, c);
+}
+
+
+// ----------------------------------------------------------------------------
+//  Natural logarithm
+// ----------------------------------------------------------------------------
+
+// Lookup tables for log_poly()
+//
+// Building the tables (starting with index 0):
+//
+//   for i=96..192: r[i-96] = float(128 / i), x[i-96] = -log(r[i-96])
+//
+// The mantissa m is scaled to [0.75, 1.5), i = rint(m * 128)
+//
+static constant int LOG_TABLE_LENGTH = 97;
+static constant float log_rcp_table[LOG_TABLE_LENGTH] = {
+    1.3333334, 1.3195876, 1.3061224, 1.2929293, 1.28, 1.2673267,
+    1.254902, 1.2427185, 1.2307693, 1.2190477, 1.2075472, 1.1962616,
+    1.1851852, 1.1743119, 1.1636363, 1.1531532, 1.1428572, 1.1327434,
+    1.122807, 1.1130434, 1.1034483, 1.0940171, 1.0847458, 1.0756303,
+    1.0666667, 1.0578512, 1.0491803, 1.0406504, 1.032258, 1.024,
+    1.0158731, 1.007874, 1.0, 0.99224806, 0.9846154, 0.97709924,
+    0.969697, 0.96240604, 0.95522386, 0.94814813, 0.9411765, 0.93430656,
+    0.92753625, 0.92086333, 0.9142857, 0.9078014, 0.90140843, 0.8951049,
+    0.8888889, 0.8827586, 0.8767123, 0.8707483, 0.8648649, 0.8590604,
+    0.85333335, 0.8476821, 0.84210527, 0.8366013, 0.83116883, 0.82580644,
+    0.82051283, 0.81528664, 0.8101266, 0.8050314, 0.8, 0.7950311,
+    0.79012346, 0.78527606, 0.7804878, 0.77575755, 0.7710843, 0.7664671,
+    0.7619048, 0.75739646, 0.7529412, 0.748538, 0.74418604, 0.7398844,
+    0.7356322, 0.73142856, 0.72727275, 0.72316384, 0.71910113, 0.7150838,
+    0.7111111, 0.70718235, 0.7032967, 0.69945353, 0.6956522, 0.6918919,
+    0.68817204, 0.684492, 0.68085104, 0.67724866, 0.67368424, 0.6701571,
+    0.6666667
+};
+
+static constant float2 log_table[LOG_TABLE_LENGTH] = {
+    float2(-0.28768212, 1.37775436e-08),
+    float2(-0.27731925, -2.1915916e-09),
+    float2(-0.26706275, -1.1320999e-08),
+    float2(-0.2569104, 6.499422e-10),
+    float2(-0.24686006, 1.5357711e-09),
+    float2(-0.23690973, 9.766833e-10),
+    float2(-0.22705749, 7.4693396e-10),
+    float2(-0.21730128, -5.6967955e-09),
+    float2(-0.2076394, -5.8405036e-09),
+    float2(-0.19806994, -6.968558e-09),
+    float2(-0.18859118, -2.476808e-09),
+    float2(-0.1792014, -3.4732086e-09),
+    float2(-0.16989905, 2.175073e-09),
+    float2(-0.16068234, -3.3536853e-09),
+    float2(-0.15154986, -5.6271574e-09),
+    float2(-0.14250009, 7.971581e-10),
+    float2(-0.13353144, -1.0038856e-09),
+    float2(-0.12464244, -2.2954132e-09),
+    float2(-0.11583182, -8.1879614e-10),
+    float2(-0.10709809, -2.253141e-09),
+    float2(-0.098440066, -3.1080047e-09),
+    float2(-0.08985638, 2.521555e-10),
+    float2(-0.08134564, -1.1937071e-09),
+    float2(-0.07290682, -6.465681e-11),
+    float2(-0.064538576, 2.4172322e-09),
+    float2(-0.056239676, -6.828925e-10),
+    float2(-0.048009165, 1.3243622e-09),
+    float2(-0.039845873, 1.3761161e-09),
+    float2(-0.031748667, -1.1529053e-09),
+    float2(-0.023716575, 4.200076e-10),
+    float2(-0.015748415, 4.321606e-10),
+    float2(-0.007843174, 3.0458194e-10),
+    float2(0.0, 0.0),
+    float2(0.007782144, 1.6100356e-10),
+    float2(0.015504186, -4.3701048e-10),
+    float2(0.023167055, 9.217028e-10),
+    float2(0.030771628, 8.4223784e-10),
+    float2(0.03831884, 2.3225787e-10),
+    float2(0.04580956, -2.0970045e-10),
+    float2(0.05324453, 1.0593088e-09),
+    float2(0.060624618, 7.905949e-12),
+    float2(0.06795067, -3.5766061e-09),
+    float2(0.0752234, 1.4222858e-09),
+    float2(0.08244365, -6.9294853e-10),
+    float2(0.089612156, -3.0509735e-09),
+    float2(0.09672966, -4.205444e-10),
+    float2(0.10379681, 2.3963673e-09),
+    float2(0.11081438, -1.4935864e-10),
+    float2(0.117783025, 3.2986907e-09),
+    float2(0.12470348, 4.3284393e-10),
+    float2(0.13157636, 5.967297e-09),
+    float2(0.13840234, 5.518903e-10),
+    float2(0.14518198, 1.920776e-09),
+    float2(0.15191604, -4.601024e-09),
+    float2(0.15860501, -3.3551462e-09),
+    float2(0.16524957, 2.6224443e-09),
+    float2(0.17185025, 3.0482164e-10),
+    float2(0.17840764, 6.566226e-09),
+    float2(0.18492234, 1.893291e-09),
+    float2(0.19139487, 2.8536042e-09),
+    float2(0.19782573, 4.444496e-10),
+    float2(0.20421553, -5.3280737e-11),
+    float2(0.21056475, -3.4910954e-09),
+    float2(0.21687397, -8.4846674e-10),
+    float2(0.22314353, 3.5408487e-09),
+    float2(0.22937408, 1.542017e-09),
+    float2(0.23556606, -8.531991e-10),
+    float2(0.24171996, -9.96172e-10),
+    float2(0.2478362, -1.2255564e-09),
+    float2(0.25391525, -8.655429e-09),
+    float2(0.25995755, 9.733653e-09),
+    float2(0.26596352, -1.3335766e-08),
+    float2(0.2719337, -7.757449e-09),
+    float2(0.27786845, -1.1723017e-08),
+    float2(0.28376815, 6.3427223e-09),
+    float2(0.28963327, 1.1054093e-08),
+    float2(0.29546422, -1.0436851e-09),
+    float2(0.30126137, -1.2483762e-08),
+    float2(0.30702505, -6.136277e-09),
+    float2(0.31275573, -1.30143025e-08),
+    float2(0.3184537, 1.9658557e-09),
+    float2(0.32411948, -1.167256e-08),
+    float2(0.32975328, -3.5580545e-09),
+    float2(0.33535558, -8.595259e-09),
+    float2(0.34092656, 4.9768945e-09),
+    float2(0.34646672, 8.592105e-09),
+    float2(0.3519764, 3.3581486e-09),
+    float2(0.3574559, 7.1436532e-09),
+    float2(0.36290547, 2.5459035e-09),
+    float2(0.36832553, 5.4616245e-09),
+    float2(0.3737164, -3.2498553e-09),
+    float2(0.37907833, 4.767729e-09),
+    float2(0.38441172, 8.153654e-09),
+    float2(0.38971677, 7.1827744e-09),
+    float2(0.39499375, 1.3158897e-08),
+    float2(0.40024316, -9.226361e-09),
+    float2(0.40546507, 1.1872889e-08)
+};
+
+// log(1 + z) = z - z^2/2 + z^3 * (1/3 - z/4 + z^2/5 - z^3/6)
+static constant float2 log1p_coef_hi[1] = { float2(0.33333334, -9.934108e-09) };
+static constant float log1p_coef_lo[3] = { -0.25f, 0.2f, -1.0f / 6.0f };
+
+// log(1 + z) for |z| <= 1/192
+static inline float2 log1p_kernel(float2 z) {
+    float2 z2 = sqr_f64(z);
+    float2 p = poly_f64(z, log1p_coef_hi, log1p_coef_lo);
+    return add_f64(z, add_f64(mul_ds(z2, -0.5f), mul_f64(mul_f64(z2, z), p)));
+}
+
+// Natural logarithm
+// a = 2^e * m, m = (1 + z) / r  =>  log(a) = e * LOG(2) - log(r) + log(1 + z)
+static float2 log_poly(float2 a) {
+    if (isnan(a.x) || ltZero(a)) return flt2(NAN);
+    if (a.x == 0.0f) return flt2(-INFINITY);
+    if (isinf(a.x)) return a;
+    
+    // Scale denormalized numbers
+    int e = 0;
+    if (a.x < FLT_MIN) {
+        a = a * 16777216.0f;    // 2^24
+        e = -24;
+    }
+    
+    // Extract exponent from float32, m = a * 2^-e is exact
+    int ea = (int)((as_type<uint>(a.x) >> 23) & 0xFF) - 127;
+    float2 m = float2(ldexp(a.x, -ea), ldexp(a.y, -ea));
+    e += ea;
+    if (m.x >= 1.5f) {
+        m = m * 0.5f;
+        e++;
+    }
+    
+    int i = int(rint(m.x * 128.0f)) - 96;
+    float r = log_rcp_table[i];
+    
+    // z = m * r - 1, calculated exactly
+    float2 p = prod(m.x, r);
+    float2 z = add_ds(add_ds(prod(m.y, r), p.y), p.x - 1.0f);
+    
+    float2 l = add_f64(log_table[i], log1p_kernel(z));
+    if (e == 0) return l;
+    
+    float fe = float(e);
+    float2 el = add_ds(mul_ds(F4_LN2.xy, fe), fe * F4_LN2.z);
+    return add_f64(el, l);
+}
+
+
+// ----------------------------------------------------------------------------
+//  Inverse tangent
+// ----------------------------------------------------------------------------
+
+// Lookup table for atan2_poly()
+//
+// Building the table (starting with index 0):
+//
+//   for j=0..64: x[j] = atan(j / 64)
+//
+static constant int ATAN_TABLE_LENGTH = 65;
+static constant float2 atan_table[ATAN_TABLE_LENGTH] = {
+    float2(0.0, 0.0),
+    float2(0.015623729, -1.2420882e-10),
+    float2(0.031239834, -2.525072e-10),
+    float2(0.046840712, 4.878767e-10),
+    float2(0.06241881, -1.0272779e-09),
+    float2(0.07796663, 3.3727106e-09),
+    float2(0.09347678, 1.3996593e-09),
+    float2(0.10894196, -3.646798e-10),
+    float2(0.124354996, -1.2403822e-09),
+    float2(0.13970888, -2.3206386e-09),
+    float2(0.15499674, 4.0861496e-09),
+    float2(0.17021193, -8.1716384e-10),
+    float2(0.18534794, 5.4976326e-09),
+    float2(0.20039855, 4.3883555e-09),
+    float2(0.2153577, -6.252999e-09),
+    float2(0.23021959, -4.0683396e-10),
+    float2(0.24497867, -3.1786778e-09),
+    float2(0.25962964, -7.5946875e-09),
+    float2(0.27416745, 2.837417e-09),
+    float2(0.28858736, 3.199044e-10),
+    float2(0.30288488, -8.353086e-09),
+    float2(0.31705576, -8.60497e-09),
+    float2(0.33109608, -6.2216645e-09),
+    float2(0.34500217, 2.8296636e-09),
+    float2(0.35877067, 1.7639499e-09),
+    float2(0.37239844, 1.0607265e-08),
+    float2(0.38588268, -6.2496617e-09),
+    float2(0.39922076, 4.938259e-09),
+    float2(0.41241044, 3.5366268e-09),
+    float2(0.42544964, -2.1887498e-09),
+    float2(0.43833655, 8.668535e-09),
+    float2(0.45106965, 2.9543132e-09),
+    float2(0.4636476, 5.0121587e-09),
+    float2(0.47606933, -8.463672e-10),
+    float2(0.48833394, 1.0550424e-08),
+    float2(0.50044084, -2.2805464e-08),
+    float2(0.5123895, -2.075692e-08),
+    float2(0.52417964, -8.649185e-09),
+    float2(0.53581125, -7.480973e-09),
+    float2(0.54728436, 1.628712e-08),
+    float2(0.5585993, 2.2111598e-08),
+    float2(0.56975645, 5.2140883e-09),
+    float2(0.58075637, -1.2685229e-08),
+    float2(0.5915997, 7.500028e-09),
+    float2(0.60228735, -5.9501493e-09),
+    float2(0.6128202, -5.907421e-09),
+    float2(0.62319934, -1.3747269e-08),
+    float2(0.6334259, -8.430239e-09),
+    float2(0.6435011, 5.8689373e-09),
+    float2(0.65342635, -7.982293e-09),
+    float2(0.663203, -8.3162455e-09),
+    float2(0.67283255, -1.0245534e-09),
+    float2(0.68231654, 1.3202995e-08),
+    float2(0.69165665, -2.7259501e-08),
+    float2(0.7008544, -1.2777476e-08),
+    float2(0.70991164, -2.5995245e-08),
+    float2(0.71883, 1.01883355e-08),
+    float2(0.7276113, 2.9297043e-08),
+    float2(0.73625743, -4.909868e-09),
+    float2(0.7447701, 1.6062602e-08),
+    float2(0.7531513, -1.660708e-08),
+    float2(0.7614028, -1.5972468e-08),
+    float2(0.7695265, -1.2227597e-09),
+    float2(0.7775243, 1.7904323e-08),
+    float2(0.7853982, -2.1855694e-08)
+};
+
+// atan(u) = u + u^3 * (-1/3 + u^2/5 - u^4/7)
+static constant float2 atan_coef_hi[1] = { float2(-0.33333334, 9.934108e-09) };
+static constant float atan_coef_lo[2] = { 0.2f, -1.0f / 7.0f };
+
+// atan(u) for |u| <= 1/128
+static inline float2 atan_kernel(float2 u) {
+    float2 u2 = sqr_f64(u);
+    return add_f64(u, mul_f64(mul_f64(u, u2), poly_f64(u2, atan_coef_hi, atan_coef_lo)));
+}
+
+// Inverse tangent of y / x in (-PI, PI]
+// Octant reduction to t = min(|x|, |y|) / max(|x|, |y|) in [0, 1], then
+// t = c + ..., c = j/64  =>  atan(t) = atan(c) + atan((t - c) / (1 + t * c))
+static float2 atan2_poly(float2 y, float2 x) {
+    if (isnan(x.x) || isnan(y.x)) return flt2(NAN);
+    
+    // The sign of a f64 is the sign of the high part
+    float2 ax = x.x < 0.0f ? -x : x;
+    float2 ay = y.x < 0.0f ? -y : y;
+    
+    // Infinite arguments: only the direction is relevant
+    if (isinf(ax.x) || isinf(ay.x)) {
+        ax = flt2(isinf(ax.x) ? 1.0f : 0.0f);
+        ay = flt2(isinf(ay.x) ? 1.0f : 0.0f);
+    }
+    
+    // y = 0 or x = 0, the signs of zeros select the result as for IEEE atan2:
+    // atan2(+-0, x) = +-pi for x < 0 or x = -0, +-0 for x > 0 or x = +0
+    if (ay.x == 0.0f) {
+        if (signbit(x.x)) return signbit(y.x) ? -F2_PI : F2_PI;
+        return y * 0.0f;    // Signed zero
+    }
+    if (ax.x == 0.0f) return y.x < 0.0f ? -F2_PI_2 : F2_PI_2;
+    
+    // Octant: swap so that the ratio is <= 1
+    bool swap = gt(ay, ax);
+    float2 num = swap ? ax : ay;
+    float2 den = swap ? ay : ax;
+    
+    // atan(num / den - c) = atan((num - c * den) / (den + c * num)),
+    // c * den and c * num are exact up to the low parts, j/64 is exact
+    float fj = rint(num.x / den.x * 64.0f);
+    float2 u;
+    if (fj == 0.0f) {
+        u = div_f64(num, den);
+    } else {
+        float c = fj * (1.0f / 64.0f);
+        u = div_f64(sub_f64(num, mul_ds(den, c)), add_f64(den, mul_ds(num, c)));
+    }
+    float2 r = add_f64(atan_table[int(fj)], atan_kernel(u));
+    
+    // Undo the octant reduction
+    if (swap) r = sub_f64(F2_PI_2, r);
+    if (ltZero(x)) r = sub_f64(F2_PI, r);
+    return y.x < 0.0f ? -r : r;
+}
+
+
+#endif
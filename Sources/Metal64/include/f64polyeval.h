@@ -0,0 +1,246 @@
+//
+//  f64polyeval.h
+//
+//  Part of Metal64
+//
+//  Polynomial evaluation templates over constant coefficient arrays
+//
+//    p(x) = c[0] + c[1] * x + ... + c[N-1] * x^(N-1)
+//
+//  Horner:  c[0] + x * (c[1] + x * (...)), N - 1 dependent multiply-adds
+//  Estrin:  pairs c[i] + c[i+1] * x are combined with x^2, x^4, ..., the
+//           dependency chain has about log2(N) multiply-adds
+//
+//  The schemes are unrolled at compile time. The coefficients are float
+//  (float polynomials) or f64 (float2 polynomials). Mixed polynomials have
+//  f64 coefficients for the leading terms and float coefficients for the
+//  tail, which is evaluated in float at x.x:
+//
+//    p(x) = hi[0] + ... + hi[NH-1] * x^(NH-1) + x^NH * (lo[0] + lo[1] * x + ...)
+//
+//  Examples:
+//
+//    static constant float2 c_hi[2] = { float2(0.5f, 0.0f), F2_1_6 };
+//    static constant float c_lo[3] = { 1.0f / 24.0f, 1.0f / 120.0f, 1.0f / 720.0f };
+//    float2 p = poly_f64(x, c_hi, c_lo);     // scheme chosen by N
+//    float2 q = horner_f64(x, c_hi, c_lo);   // Horner
+//
+//  Latency and throughput (ns/call) on the host, coefficients 1/k!, |x| <= 1/2
+//  (Host/Benchmarks/bench_polyeval.cpp, 1 thread, g++ -O2 -ffp-contract=off,
+//  x86 without FMA, range of two runs):
+//
+//    type    N    Horner lat   Estrin lat   Horner thr   Estrin thr
+//    float   8     19.4-20.0     9.8-10.2      2.1-2.2      2.1-2.2
+//    float  16     39.9-41.7    13.0-17.6     7.0-10.6      4.7-7.2
+//    f64     4     56.7-57.5    58.6-60.7    40.0-43.7    23.2-28.4
+//    f64     8    125.6-135.3  131.3-142.3   94.5-99.8    95.9-98.3
+//    f64    12    259.9-281.0  184.4-193.2  229.5-249.2  167.6-185.9
+//    f64    16    422.1-437.7  264.6-286.7  378.9-396.1  234.5-289.4
+//
+//  For f64, Estrin is less accurate (1.5 - 2.05 versus 1.06 - 1.16 ulp) and
+//  only faster from 12 coefficients on, the f64 schemes are therefore chosen
+//  by N (POLY_ESTRIN_MIN_F64). The polynomials of f64poly.h have at most 8
+//  coefficients and use Horner.
+//
+//  Requires f64fnc.h
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __F64POLYEVAL_H
+#define __F64POLYEVAL_H
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Build options
+// ----------------------------------------------------------------------------
+
+// Scheme of poly() and poly_f64(), used by the kernels of f64poly.h:
+//
+//   1 = Estrin (shorter dependency chain, a few more operations) for float
+//       polynomials and for f64 polynomials of at least POLY_ESTRIN_MIN_F64
+//       coefficients, Horner for shorter f64 polynomials
+//   0 = Horner
+#ifndef METAL64_POLY_ESTRIN
+#define METAL64_POLY_ESTRIN 1
+#endif
+
+// Smallest number of coefficients of an f64 polynomial evaluated with Estrin
+static constant int POLY_ESTRIN_MIN_F64 = 12;
+
+// Levels of the Estrin scheme, up to 2^POLY_MAX_LEVELS coefficients
+static constant int POLY_MAX_LEVELS = 4;
+
+
+// ----------------------------------------------------------------------------
+//  Arithmetic of the coefficient types
+// ----------------------------------------------------------------------------
+
+static inline float poly_add(float a, float b) { return a + b; }
+static inline float poly_mul(float a, float b) { return a * b; }
+static inline float poly_sqr(float a) { return a * a; }
+
+static inline float2 poly_add(float2 a, float2 b) { return add_f64(a, b); }
+static inline float2 poly_mul(float2 a, float2 b) { return mul_f64(a, b); }
+static inline float2 poly_sqr(float2 a) { return sqr_f64(a); }
+
+// Largest power of 2 below m (m >= 2)
+constexpr int poly_split(int m) {
+    return m <= 2 ? 1 : 2 * poly_split((m + 1) / 2);
+}
+
+// log2 of a power of 2
+constexpr int poly_log2(int h) {
+    return h <= 1 ? 0 : 1 + poly_log2(h / 2);
+}
+
+// Number of powers x, x^2, x^4, ... used by Estrin for n coefficients
+constexpr int poly_levels(int n) {
+    return n <= 1 ? 0 : poly_log2(poly_split(n)) + 1;
+}
+
+
+// ----------------------------------------------------------------------------
+//  Horner
+// ----------------------------------------------------------------------------
+
+// c[I] + x * c[I+1] + ... + x^(M-1) * c[I+M-1]
+template <typename T, int I, int M>
+struct poly_horner_step {
+    static inline T eval(T x, constant T *c) {
+        return poly_add(c[I], poly_mul(x, poly_horner_step<T, I + 1, M - 1>::eval(x, c)));
+    }
+};
+
+template <typename T, int I>
+struct poly_horner_step<T, I, 1> {
+    static inline T eval(T, constant T *c) {
+        return c[I];
+    }
+};
+
+
+// ----------------------------------------------------------------------------
+//  Estrin
+// ----------------------------------------------------------------------------
+
+// Powers p[k] = x^(2^k)
+template <typename T>
+struct poly_powers {
+    T p[POLY_MAX_LEVELS];
+};
+
+template <typename T, int N>
+static inline poly_powers<T> poly_make_powers(T x) {
+    poly_powers<T> pw;
+    pw.p[0] = x;
+    for (int k = 1; k < poly_levels(N); k++) {
+        pw.p[k] = poly_sqr(pw.p[k - 1]);
+    }
+    return pw;
+}
+
+// c[I] + ... + x^(M-1) * c[I+M-1] = low half + x^H * high half, H = 2^k < M
+template <typename T, int I, int M>
+struct poly_estrin_step {
+    static inline T eval(poly_powers<T> pw, constant T *c) {
+        const int H = poly_split(M);
+        T lo = poly_estrin_step<T, I, H>::eval(pw, c);
+        T hi = poly_estrin_step<T, I + H, M - H>::eval(pw, c);
+        return poly_add(lo, poly_mul(pw.p[poly_log2(H)], hi));
+    }
+};
+
+template <typename T, int I>
+struct poly_estrin_step<T, I, 1> {
+    static inline T eval(poly_powers<T>, constant T *c) {
+        return c[I];
+    }
+};
+
+
+// ----------------------------------------------------------------------------
+//  float polynomials
+// ----------------------------------------------------------------------------
+
+template <int N>
+static inline float horner(float x, constant float (&c)[N]) {
+    return poly_horner_step<float, 0, N>::eval(x, c);
+}
+
+template <int N>
+static inline float estrin(float x, constant float (&c)[N]) {
+    static_assert(N <= (1 << POLY_MAX_LEVELS), "too many coefficients");
+    return poly_estrin_step<float, 0, N>::eval(poly_make_powers<float, N>(x), c);
+}
+
+template <int N>
+static inline float poly(float x, constant float (&c)[N]) {
+#if METAL64_POLY_ESTRIN
+    return estrin(x, c);
+#else
+    return horner(x, c);
+#endif
+}
+
+
+// ----------------------------------------------------------------------------
+//  f64 polynomials
+// ----------------------------------------------------------------------------
+
+template <int N>
+static inline float2 horner_f64(float2 x, constant float2 (&c)[N]) {
+    return poly_horner_step<float2, 0, N>::eval(x, c);
+}
+
+template <int N>
+static inline float2 estrin_f64(float2 x, constant float2 (&c)[N]) {
+    static_assert(N <= (1 << POLY_MAX_LEVELS), "too many coefficients");
+    return poly_estrin_step<float2, 0, N>::eval(poly_make_powers<float2, N>(x), c);
+}
+
+template <int N>
+static inline float2 poly_f64(float2 x, constant float2 (&c)[N]) {
+#if METAL64_POLY_ESTRIN
+    if (N >= POLY_ESTRIN_MIN_F64) return estrin_f64(x, c);
+#endif
+    return horner_f64(x, c);
+}
+
+
+// ----------------------------------------------------------------------------
+//  Mixed polynomials: f64 head, float tail
+// ----------------------------------------------------------------------------
+
+// The tail enters the head as the last coefficient hi[NH-1] + x * tail
+template <int NH, int NT>
+static inline float2 horner_f64(float2 x, constant float2 (&hi)[NH], constant float (&lo)[NT]) {
+    float2 p = add_ds(hi[NH - 1], x.x * horner(x.x, lo));
+    for (int i = NH - 2; i >= 0; i--) {
+        p = add_f64(hi[i], mul_f64(x, p));
+    }
+    return p;
+}
+
+// Head and tail are independent, they are joined with x^NH
+template <int NH, int NT>
+static inline float2 estrin_f64(float2 x, constant float2 (&hi)[NH], constant float (&lo)[NT]) {
+    float t = estrin(x.x, lo);
+    float xn = x.x;
+    for (int i = 1; i < NH; i++) {
+        xn *= x.x;
+    }
+    return add_ds(estrin_f64(x, hi), xn * t);
+}
+
+template <int NH, int NT>
+static inline float2 poly_f64(float2 x, constant float2 (&hi)[NH], constant float (&lo)[NT]) {
+#if METAL64_POLY_ESTRIN
+    if (NH + NT >= POLY_ESTRIN_MIN_F64) return estrin_f64(x, hi, lo);
+#endif
+    return horner_f64(x, hi, lo);
+}
+
+#endif
@@ -0,0 +1,245 @@
+//
+//  f64reduce.h
+//
+//  Part of Metal64
+//
+//  Parallel reductions over f64 and c64 buffers: sum, dot product,
+//  euclidean norm, minimum and maximum
+//
+//  The reductions use a two level layout:
+//
+//    1. Every thread accumulates a part of the buffer into a state
+//       (reduce_thread: strided access for coalesced GPU loads,
+//        reduce_block:  contiguous block, preferred on the CPU)
+//    2. The states of a threadgroup are combined in a binary tree in
+//       threadgroup memory (reduce_tree_step / reduce_threadgroup).
+//       The partial results of the threadgroups are combined the same way
+//       by a second pass or on the host.
+//
+//  Sums and dot products use the compensated accumulator of f64acc.h, so the
+//  error grows only with n u^3 sum(|a_i|) (u = 2^-24) instead of n u^2 for a
+//  chain of f64 additions. The rounding of the accumulator depends on how the
+//  buffer is split: results for different thread or group counts agree within
+//  the error bound, but are not bit-identical.
+//
+//  Metal kernel:
+//
+//    kernel void sum_kernel(device const float2 *a [[ buffer(0) ]],
+//                           constant uint &n [[ buffer(1) ]],
+//                           device float4 *partial [[ buffer(2) ]],
+//                           uint pos [[ thread_position_in_grid ]],
+//                           uint threads [[ threads_per_grid ]],
+//                           uint tid [[ thread_position_in_threadgroup ]],
+//                           uint size [[ threads_per_threadgroup ]],
+//                           uint group [[ threadgroup_position_in_grid ]]) {
+//        threadgroup float4 s[256];
+//        float4 v = reduce_thread<sum_f64_op>(a, a, n, pos, threads);
+//        v = reduce_threadgroup<sum_f64_op>(s, v, tid, size);
+//        if (tid == 0) partial[group] = v;
+//    }
+//
+//  The host version (Host/CPUReduce.h) runs both levels on all CPU cores.
+//
+//  Created by Dirk Braner on 20.04.26.
+//
+
+#ifndef __F64REDUCE_H
+#define __F64REDUCE_H
+
+#include "c64.h"
+#include "f64acc.h"
+
+using namespace metal;
+
+
+// ----------------------------------------------------------------------------
+//  Reduction operators
+//
+//  element  Type of the buffer elements
+//  state    Partial result of a thread or threadgroup
+//  result   Final result
+//
+//  identity()          Neutral state
+//  add(s, a, b, i)     Add element i (b is only used by dot products)
+//  combine(s, t)       Combine two partial states
+//  value(s)            Result of a state
+// ----------------------------------------------------------------------------
+
+// Compensated accumulator for complex values
+struct acc_c64 {
+    float4 re;
+    float4 im;
+};
+
+static inline acc_c64 acc_c64_merge(acc_c64 a, acc_c64 b) {
+    acc_c64 r;
+    r.re = acc_merge(a.re, b.re);
+    r.im = acc_merge(a.im, b.im);
+    return r;
+}
+
+// Sum of f64 values
+struct sum_f64_op {
+    typedef float2 element;
+    typedef float4 state;
+    typedef float2 result;
+
+    static state identity() { return float4(0.0f); }
+    static state add(state s, device const element *a, device const element *, uint i) { return acc_add(s, a[i]); }
+    static state combine(state s, state t) { return acc_merge(s, t); }
+    static result value(state s) { return acc_value(s); }
+};
+
+// Dot product of f64 vectors
+struct dot_f64_op {
+    typedef float2 element;
+    typedef float4 state;
+    typedef float2 result;
+
+    static state identity() { return float4(0.0f); }
+    static state add(state s, device const element *a, device const element *b, uint i) { return acc_add_mul(s, a[i], b[i]); }
+    static state combine(state s, state t) { return acc_merge(s, t); }
+    static result value(state s) { return acc_value(s); }
+};
+
+// Euclidean norm of a f64 vector: sqrt(sum(a * a))
+struct norm_f64_op {
+    typedef float2 element;
+    typedef float4 state;
+    typedef float2 result;
+
+    static state identity() { return float4(0.0f); }
+    static state add(state s, device const element *a, device const element *, uint i) { return acc_add_mul(s, a[i], a[i]); }
+    static state combine(state s, state t) { return acc_merge(s, t); }
+    static result value(state s) { return sqrt_f64(acc_value(s)); }
+};
+
+// Minimum of f64 values
+struct min_f64_op {
+    typedef float2 element;
+    typedef float2 state;
+    typedef float2 result;
+
+    static state identity() { return float2(INFINITY, 0.0f); }
+    static state add(state s, device const element *a, device const element *, uint i) { return lt(a[i], s) ? a[i] : s; }
+    static state combine(state s, state t) { return lt(t, s) ? t : s; }
+    static result value(state s) { return s; }
+};
+
+// Maximum of f64 values
+struct max_f64_op {
+    typedef float2 element;
+    typedef float2 state;
+    typedef float2 result;
+
+    static state identity() { return float2(-INFINITY, 0.0f); }
+    static state add(state s, device const element *a, device const element *, uint i) { return gt(a[i], s) ? a[i] : s; }
+    static state combine(state s, state t) { return gt(t, s) ? t : s; }
+    static result value(state s) { return s; }
+};
+
+// Sum of c64 values
+struct sum_c64_op {
+    typedef float4 element;
+    typedef acc_c64 state;
+    typedef float4 result;
+
+    static state identity() { acc_c64 s; s.re = float4(0.0f); s.im = float4(0.0f); return s; }
+    static state add(state s, device const element *a, device const element *, uint i) {
+        s.re = acc_add(s.re, a[i].xy);
+        s.im = acc_add(s.im, a[i].zw);
+        return s;
+    }
+    static state combine(state s, state t) { return acc_c64_merge(s, t); }
+    static result value(state s) { return float4(acc_value(s.re), acc_value(s.im)); }
+};
+
+// Dot product of c64 vectors without conjugation: sum(a * b)
+struct dot_c64_op {
+    typedef float4 element;
+    typedef acc_c64 state;
+    typedef float4 result;
+
+    static state identity() { acc_c64 s; s.re = float4(0.0f); s.im = float4(0.0f); return s; }
+    static state add(state s, device const element *a, device const element *b, uint i) {
+        float4 x = a[i];
+        float4 y = b[i];
+        s.re = acc_add_mul(acc_add_mul(s.re, x.xy, y.xy), -x.zw, y.zw);
+        s.im = acc_add_mul(acc_add_mul(s.im, x.xy, y.zw), x.zw, y.xy);
+        return s;
+    }
+    static state combine(state s, state t) { return acc_c64_merge(s, t); }
+    static result value(state s) { return float4(acc_value(s.re), acc_value(s.im)); }
+};
+
+// Euclidean norm of a c64 vector: sqrt(sum(norm(a)))
+struct norm_c64_op {
+    typedef float4 element;
+    typedef float4 state;
+    typedef float2 result;
+
+    static state identity() { return float4(0.0f); }
+    static state add(state s, device const element *a, device const element *, uint i) {
+        float4 x = a[i];
+        return acc_add_mul(acc_add_mul(s, x.xy, x.xy), x.zw, x.zw);
+    }
+    static state combine(state s, state t) { return acc_merge(s, t); }
+    static result value(state s) { return sqrt_f64(acc_value(s)); }
+};
+
+
+// ----------------------------------------------------------------------------
+//  Level 1: per thread
+// ----------------------------------------------------------------------------
+
+// Elements pos, pos + threads, pos + 2 * threads, ... (coalesced GPU access)
+template <typename Op>
+static typename Op::state reduce_thread(device const typename Op::element *a, device const typename Op::element *b,
+                                        uint n, uint pos, uint threads) {
+    typename Op::state s = Op::identity();
+    for (uint i = pos; i < n; i += threads) {
+        s = Op::add(s, a, b, i);
+    }
+    return s;
+}
+
+// Elements [begin, end)
+template <typename Op>
+static typename Op::state reduce_block(device const typename Op::element *a, device const typename Op::element *b,
+                                       uint begin, uint end) {
+    typename Op::state s = Op::identity();
+    for (uint i = begin; i < end; i++) {
+        s = Op::add(s, a, b, i);
+    }
+    return s;
+}
+
+
+// ----------------------------------------------------------------------------
+//  Level 2: per threadgroup
+// ----------------------------------------------------------------------------
+
+// One level of the tree: s[tid] = s[tid] + s[tid + stride] for tid < stride
+template <typename Op>
+static inline void reduce_tree_step(threadgroup typename Op::state *s, uint tid, uint stride) {
+    if (tid < stride) {
+        s[tid] = Op::combine(s[tid], s[tid + stride]);
+    }
+}
+
+#ifdef __METAL_VERSION__
+// Tree reduction of the states v of all threads in a threadgroup
+// s = threadgroup memory for size states, size must be a power of 2
+template <typename Op>
+static typename Op::state reduce_threadgroup(threadgroup typename Op::state *s, typename Op::state v, uint tid, uint size) {
+    s[tid] = v;
+    for (uint stride = size / 2; stride > 0; stride >>= 1) {
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+        reduce_tree_step<Op>(s, tid, stride);
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+    return s[0];
+}
+#endif
+
+#endif